@@ -15,40 +15,74 @@
 #include <camkes.h>
 
 #include "glue_tls_mqtt.h"
-#include "helper_func.h"
+#include "config_cache.h"
+#include "config_params.h"
+#include "config_snapshot.h"
+#include "boot_trace.h"
+#include "trace.h"
+#include "metrics.h"
 
 #include "MQTT_client.h"
 #include "MQTTServer.h"
 
+#if defined(MQTT_BENCHMARK)
+#include "MQTT_bench.h"
+#endif
+
 #include "lib_utils/managedBuffer.h"
 
 /* Defines -------------------------------------------------------------------*/
-// the following defines are the parameter names that need to match the settings
-// in the configuration xml file. These will be passed to the configServer
-// component to retrieve the settings for the specified parameter
-#define DOMAIN_CLOUDCONNECTOR   "Domain-CloudConnector"
-#define CLOUD_DEVICE_ID_NAME    "IoT-Device"
-#define CLOUD_DOMAIN_NAME       "IoT-Hub"
-#define SERVER_ADDRESS_NAME     "CloudServiceIP"
-#define CLOUD_SAS_NAME          "SharedAccessSignature"
-#define SERVER_PORT_NAME        "ServerPort"
-#define SERVER_CA_CERT_NAME     "ServerCaCert"
+// the names, IDs and sizes of the parameters are generated from the
+// configuration xml file into config_params.h
+#define DOMAIN_CLOUDCONNECTOR   CONFIG_CLOUD_CONNECTOR_NAME
 
 
 #define PAHO_TIMEOUT_MS_LISTEN   (1000 * 60 * 5)
 #define PAHO_TIMEOUT_MS_COMMAND  (1000 * 60 * 5)
-#define PAHO_SEND_BUFF_SIZE      1024
+// the client sends the metrics in one packet, see metrics.h
+#define PAHO_SEND_BUFF_SIZE      (Metrics_FORMAT_SIZE + 1024)
 #define PAHO_RECV_BUFF_SIZE      1024
 
-// sizes chosen to at least fit the expected sizes of the parameters
-static char cloudDeviceName[128];
-static char cloudUsername[128];
-static char cloudSAS[192];
-static char serverIP[32];
-static char serverCert[4096];
+// All sizes come from config_params.h, blobs get space for a terminating
+// zero. The metrics topic can be changed at runtime, but the ConfigServer
+// denies any value larger than the generated size.
+static char cloudDeviceName[CONFIG_CLOUD_CONNECTOR_IOT_DEVICE_SIZE];
+static char cloudUsername[CONFIG_CLOUD_CONNECTOR_IOT_HUB_SIZE + 1];
+static char cloudSAS[CONFIG_CLOUD_CONNECTOR_SHARED_ACCESS_SIGNATURE_SIZE + 1];
+static char serverIP[CONFIG_CLOUD_CONNECTOR_CLOUD_SERVICE_IP_SIZE];
+static int32_t serverPort;
+static char serverCert[CONFIG_CLOUD_CONNECTOR_SERVER_CA_CERT_SIZE + 1];
+static char metricsTopic[CONFIG_CLOUD_CONNECTOR_METRICS_TOPIC_SIZE + 1];
 
 /* Instance variables --------------------------------------------------------*/
-OS_ConfigServiceHandle_t hConfig;
+// all parameters of the CloudConnector domain, fetched on start-up and again
+// whenever the domain changes
+static ConfigCache_t configCache;
+
+static const ConfigSnapshot_t configSnapshot =
+    ConfigSnapshot_ASSIGN(
+        configSnapshot_port,
+        CONFIG_SNAPSHOT_SIZE);
+
+static const if_OS_Timer_t timer =
+    IF_OS_TIMER_ASSIGN(
+        timeServer_rpc,
+        timeServer_notify);
+
+static const BootTrace_t bootTrace =
+    BootTrace_ASSIGN(
+        bootTrace_port,
+        &timer,
+        BOOT_TRACE_CLOUDCONNECTOR_SLOT,
+        "CloudConnector");
+
+// The trace id and the sampling time the sensor passes with a message.
+typedef struct
+{
+    uint32_t            id;
+    uint64_t            sampleTimeNs;
+} CC_MsgTrace_t;
+
 typedef struct
 {
     Network             net;
@@ -74,13 +108,41 @@ typedef struct
         char                    buffer[PAHO_RECV_BUFF_SIZE];
     } tmpDataPublish;
 
+    MQTTPacket_connectData      connectOptions;
+
+    // a changed configuration is used with the next connection to the cloud
+    bool                        isConnected;
+    uint32_t                    configVersion;
+
+    // the boot trace is written to the log after the first publish
+    bool                        hasPublished;
+
+    // TimeServer time in s when the metrics were published last
+    uint64_t                    metricsPublishedS;
+
+    // the message that is handled, for the tracepoints
+    CC_MsgTrace_t               msgTrace;
+
+    // set once run() has tried to connect, until then the RPC thread only
+    // queues the sensor messages
+    bool                        isInitialized;
+    bool                        hasConfig;
+
+    // the TLS context keeps the parsed CA certificate across reconnects, it
+    // is read and parsed again after the certificate has changed
+    bool                        hasCaCert;
+
+    // sensor messages that arrive while there is no connection to the cloud,
+    // sent in order once the connection is up
     struct
     {
-        size_t                  connect;
-        size_t                  pingreq;
-        size_t                  publish;
-        size_t                  filtered;
-    } cnt;
+        unsigned char           msg[CLOUDCONNECTOR_PRE_CONNECT_QUEUE_SIZE]
+                                   [PAHO_RECV_BUFF_SIZE];
+        CC_MsgTrace_t           msgTrace[CLOUDCONNECTOR_PRE_CONNECT_QUEUE_SIZE];
+        size_t                  head;
+        size_t                  count;
+        size_t                  dropped;
+    } preConnect;
 }
 CC_FSM_t;
 
@@ -90,12 +152,40 @@ static CC_FSM_t cc_fsm;
 // external resources
 //==============================================================================
 
-OS_Error_t init_config_handle(OS_ConfigServiceHandle_t* configHandle);
+OS_Error_t init_config_cache(ConfigCache_t* configCache, const char* domainName);
 
 //==============================================================================
 // internal functions
 //==============================================================================
 
+//------------------------------------------------------------------------------
+// Fetch the domain into the cache and check once that its parameters match the
+// generated IDs, all further reads are done by ID.
+static
+OS_Error_t
+fetch_config(void)
+{
+    static const char* const names[] = CONFIG_CLOUD_CONNECTOR_PARAMETER_NAMES;
+
+    OS_Error_t err = init_config_cache(&configCache, DOMAIN_CLOUDCONNECTOR);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("init_config_cache() failed with: %d", err);
+        return err;
+    }
+
+    err = ConfigCache_checkNames(&configCache,
+                                 names,
+                                 CONFIG_CLOUD_CONNECTOR_NUM_PARAMETERS);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("ConfigCache_checkNames() failed with: %d", err);
+        return err;
+    }
+
+    return OS_SUCCESS;
+}
+
 //------------------------------------------------------------------------------
 static
 OS_Error_t
@@ -119,41 +209,35 @@ OS_Error_t
 set_mqtt_options(MQTTPacket_connectData* options)
 {
 
-    OS_Error_t ret = helper_func_getConfigParameter(&hConfig,
-                                                    DOMAIN_CLOUDCONNECTOR,
-                                                    CLOUD_DOMAIN_NAME,
-                                                    cloudUsername,
-                                                    sizeof(cloudUsername));
+    OS_Error_t ret = ConfigParams_CloudConnector_IoT_Hub(&configCache,
+                                                         cloudUsername,
+                                                         sizeof(cloudUsername));
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s failed with :%d",
-                        CLOUD_DOMAIN_NAME, ret);
+        Debug_LOG_ERROR("Reading param %s failed with :%d",
+                        CONFIG_CLOUD_CONNECTOR_IOT_HUB_NAME, ret);
         return ret;
     }
     Debug_LOG_DEBUG("Retrieved CloudDomain: %s", cloudUsername);
 
-    ret = helper_func_getConfigParameter(&hConfig,
-                                         DOMAIN_CLOUDCONNECTOR,
-                                         CLOUD_SAS_NAME,
-                                         cloudSAS,
-                                         sizeof(cloudSAS));
+    ret = ConfigParams_CloudConnector_SharedAccessSignature(&configCache,
+                                                            cloudSAS,
+                                                            sizeof(cloudSAS));
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s failed with :%d",
-                        CLOUD_SAS_NAME, ret);
+        Debug_LOG_ERROR("Reading param %s failed with :%d",
+                        CONFIG_CLOUD_CONNECTOR_SHARED_ACCESS_SIGNATURE_NAME, ret);
         return ret;
     }
     Debug_LOG_DEBUG("Retrieved CloudSAS: %s", cloudSAS);
 
-    ret = helper_func_getConfigParameter(&hConfig,
-                                         DOMAIN_CLOUDCONNECTOR,
-                                         CLOUD_DEVICE_ID_NAME,
-                                         cloudDeviceName,
-                                         sizeof(cloudDeviceName));
+    ret = ConfigParams_CloudConnector_IoT_Device(&configCache,
+                                                 cloudDeviceName,
+                                                 sizeof(cloudDeviceName));
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s failed with :%d",
-                        CLOUD_DEVICE_ID_NAME, ret);
+        Debug_LOG_ERROR("Reading param %s failed with :%d",
+                        CONFIG_CLOUD_CONNECTOR_IOT_DEVICE_NAME, ret);
         return ret;
     }
     Debug_LOG_DEBUG("Retrieved DeviceName: %s", cloudDeviceName);
@@ -217,6 +301,9 @@ static int do_process_publish(CC_FSM_t* self,
         return -1;
     }
 
+    TRACE_POINT(CC_PUBLISH_PARSED, self->msgTrace.id, topic->len,
+                msg->payloadlen);
+
     // sanity check: topic and payload must be in input buffer. Actually, there
     // should be no need to check this, as MQTTDeserialize_publish() should
     // do such kind of checks already.
@@ -292,8 +379,7 @@ static int do_process_publish(CC_FSM_t* self,
 //------------------------------------------------------------------------------
 static int handle_MQTT_CONNECT(CC_FSM_t* self)
 {
-    self->cnt.connect++;
-    Debug_LOG_DEBUG("received MQTT CONNECT #%u", self->cnt.connect);
+    Debug_LOG_DEBUG("received MQTT CONNECT");
     MQTTServer_sendConnAck(&self->paho.server, 0, 0);
 
     return 0;
@@ -304,6 +390,7 @@ static int handle_MQTT_PINGREQ(CC_FSM_t* self)
 {
     // For the scope of this demo, we will ignore the MQTT Subscribe events
     Debug_LOG_WARNING("received MQTT PINGREQ, ignored");
+    Metrics_add(METRICS_IGNORED, 1);
 
     return 0;
 }
@@ -313,6 +400,7 @@ static int handle_MQTT_SUBSCRIBE(CC_FSM_t* self)
 {
     // For the scope of this demo, we will ignore the MQTT Subsribe events
     Debug_LOG_WARNING("received MQTT SUBSCRIBE, ignored");
+    Metrics_add(METRICS_IGNORED, 1);
 
     return 0;
 }
@@ -322,6 +410,7 @@ static int handle_MQTT_unsupportedPacket(CC_FSM_t* self,
                                          int packet_type)
 {
     Debug_LOG_WARNING("received unsupported packet type %d, ignored", packet_type);
+    Metrics_add(METRICS_IGNORED, 1);
 
     // we've received a unsupported packet, ignore this
 
@@ -334,8 +423,8 @@ static int handle_MQTT_PUBLISH(CC_FSM_t* self)
     // in case of error we wait for the next packet. This is ok, as there is
     // no channel to the sender of the packets to report errors.
 
-    self->cnt.publish++;
-    Debug_LOG_DEBUG("received MQTT PUBLISH #%u", self->cnt.publish);
+    TRACE_POINT(CC_PUBLISH_RX, self->msgTrace.id,
+                Metrics_getCounter(METRICS_MESSAGES));
 
     // the buffer from the MQTT server connection holds the packet. Process it
     // and populate a message that is send out on the WAN
@@ -351,83 +440,156 @@ static int handle_MQTT_PUBLISH(CC_FSM_t* self)
         return 0;
     }
 
-    //
-
+    // the call returns when the PUBACK has been received
+    const uint64_t startUs = glue_tls_mqtt_getTimeUs();
     ret = MQTT_client_publish(&(self->paho.client),
                               self->tmpDataPublish.szTopic,
                               &(self->tmpDataPublish.msg),
                               NULL);
+    TRACE_POINT(CC_PUBLISH_SENT, self->msgTrace.id, ret,
+                Trace_getElapsedUs(self->msgTrace.sampleTimeNs));
     if (ret != MQTT_SUCCESS)
     {
         Debug_LOG_ERROR("MQTTPublish() failed with code %d", ret);
+        Metrics_add(METRICS_PUBLISH_ERRORS, 1);
         MQTT_client_disconnect(&self->paho.client);
+        glue_tls_close();
+        self->isConnected = false;
+        Metrics_set(METRICS_CONNECTED, 0);
         return -1;
     }
+    Metrics_observe(METRICS_PUBLISH_RTT,
+                    (uint32_t)(glue_tls_mqtt_getTimeUs() - startUs));
+    Metrics_add(METRICS_PUBLISHES, 1);
     Debug_LOG_INFO("MQTT publish on WAN successful");
 
+    if (!self->hasPublished)
+    {
+        self->hasPublished = true;
+        BOOT_TRACE_MARK(&bootTrace, "first_puback");
+        BOOT_TRACE_DUMP(&bootTrace);
+    }
+
     return 0;
 }
 
+//==============================================================================
+// connection stages
+//==============================================================================
+
 //------------------------------------------------------------------------------
-static int handle_CC_FSM_INIT(CC_FSM_t* self)
+static OS_Error_t stage_fetch_config(CC_FSM_t* self)
 {
+    OS_Error_t ret = fetch_config();
+    if (ret != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("fetch_config() failed with: %d", ret);
+        return ret;
+    }
+    self->hasConfig = true;
+
+    // the cache is up to date with the current version of the domain
+    ConfigSnapshot_hasDomainChanged(&configSnapshot,
+                                    DOMAIN_CLOUDCONNECTOR,
+                                    &self->configVersion);
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static OS_Error_t stage_mqtt_options(CC_FSM_t* self)
+{
+    Debug_LOG_DEBUG("Setting MQTT options ..." );
+    MQTTPacket_connectData options = MQTTPacket_connectData_initializer;
+    self->connectOptions = options;
 
-    OS_Error_t ret = helper_func_getConfigParameter(&hConfig,
-                                                    DOMAIN_CLOUDCONNECTOR,
-                                                    SERVER_ADDRESS_NAME,
-                                                    &serverIP,
-                                                    sizeof(serverIP));
+    OS_Error_t ret = set_mqtt_options(&self->connectOptions);
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s failed with :%d",
-                        SERVER_ADDRESS_NAME, ret);
+        Debug_LOG_ERROR("set_mqtt_options() failed with code %d", ret);
         return ret;
     }
 
-    uint32_t serverPort;
-    ret = helper_func_getConfigParameter(&hConfig,
-                                         DOMAIN_CLOUDCONNECTOR,
-                                         SERVER_PORT_NAME,
-                                         &serverPort,
-                                         sizeof(serverPort));
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// Set up crypto and TLS, which also parses the CA certificate. None of this
+// needs the network. A reconnect reuses the contexts of the last connection.
+static OS_Error_t stage_tls_setup(CC_FSM_t* self)
+{
+    if (self->hasCaCert)
+    {
+        return glue_tls_setup(serverCert);
+    }
+
+    // the contexts may hold an older CA certificate
+    glue_tls_free();
+
+    OS_Error_t ret = ConfigParams_CloudConnector_ServerCaCert(&configCache,
+                                                              &serverCert,
+                                                              sizeof(serverCert) - 1);
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s failed with :%d",
-                        SERVER_PORT_NAME, ret);
+        Debug_LOG_ERROR("Reading param %s failed with :%d",
+                        CONFIG_CLOUD_CONNECTOR_SERVER_CA_CERT_NAME, ret);
         return ret;
     }
 
-    ret = helper_func_getConfigParameter(&hConfig,
-                                         DOMAIN_CLOUDCONNECTOR,
-                                         SERVER_CA_CERT_NAME,
-                                         &serverCert,
-                                         sizeof(serverCert));
+    ret = glue_tls_setup(serverCert);
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s failed with :%d",
-                        SERVER_CA_CERT_NAME, ret);
+        Debug_LOG_ERROR("glue_tls_setup() failed with code %d", ret);
         return ret;
     }
+    self->hasCaCert = true;
 
-    Debug_LOG_DEBUG("Setting MQTT options ..." );
-    MQTTPacket_connectData options = MQTTPacket_connectData_initializer;
-    ret = set_mqtt_options(&options);
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static OS_Error_t stage_network_ready(CC_FSM_t* self)
+{
+    return glue_tls_waitForNetworkStack();
+}
+
+//------------------------------------------------------------------------------
+static OS_Error_t stage_socket_connect(CC_FSM_t* self)
+{
+    OS_Error_t ret = ConfigParams_CloudConnector_CloudServiceIP(&configCache,
+                                                                &serverIP,
+                                                                sizeof(serverIP));
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("set_mqtt_options() failed with code %d", ret);
+        Debug_LOG_ERROR("Reading param %s failed with :%d",
+                        CONFIG_CLOUD_CONNECTOR_CLOUD_SERVICE_IP_NAME, ret);
         return ret;
     }
 
-    Debug_LOG_INFO("Setting TLS to IP:%s Port:%u ...", serverIP, serverPort);
-    ret = glue_tls_init(serverIP, serverCert, sizeof(serverCert), serverPort);
+    ret = ConfigParams_CloudConnector_ServerPort(&configCache, &serverPort);
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("glue_tls_init() failed with code %d", ret);
+        Debug_LOG_ERROR("Reading param %s failed with :%d",
+                        CONFIG_CLOUD_CONNECTOR_SERVER_PORT_NAME, ret);
         return ret;
     }
 
+    Debug_LOG_INFO("Connecting to IP:%s Port:%u ...", serverIP, serverPort);
+    ret = glue_tls_connect(serverIP, serverPort);
+    if (ret != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("glue_tls_connect() failed with code %d", ret);
+        return ret;
+    }
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static OS_Error_t stage_tls_handshake(CC_FSM_t* self)
+{
     Debug_LOG_INFO("Establishing TLS session... ");
-    ret = do_tls_handshake();
+    OS_Error_t ret = do_tls_handshake();
     if (ret != OS_SUCCESS)
     {
         Debug_LOG_ERROR("do_tls_handshake() failed with code %d", ret);
@@ -435,21 +597,340 @@ static int handle_CC_FSM_INIT(CC_FSM_t* self)
     }
     Debug_LOG_INFO("TLS session established successfully");
 
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static OS_Error_t stage_mqtt_connect(CC_FSM_t* self)
+{
     Debug_LOG_INFO("Establishing MQTT connection... ");
-    ret = do_mqtt_connect(&self->paho.client, &options);
+    const uint64_t startUs = glue_tls_mqtt_getTimeUs();
+    int ret = do_mqtt_connect(&self->paho.client, &self->connectOptions);
     if (ret != 0)
     {
         Debug_LOG_ERROR("do_mqtt_connect() failed with code %d", ret);
+        return OS_ERROR_GENERIC;
+    }
+    Metrics_observe(METRICS_MQTT_CONNECT,
+                    (uint32_t)(glue_tls_mqtt_getTimeUs() - startUs));
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// The stages of a connection to the cloud, they run one after the other in
+// this order. The names are also the phases of the boot trace.
+typedef struct
+{
+    const char* name;
+    OS_Error_t  (*run)(CC_FSM_t* self);
+} CC_Stage_t;
+
+enum
+{
+    CC_STAGE_CONFIG,
+    CC_STAGE_MQTT_OPTIONS,
+    CC_STAGE_TLS_SETUP,
+    CC_STAGE_NETWORK,
+    CC_STAGE_SOCKET,
+    CC_STAGE_TLS_HANDSHAKE,
+    CC_STAGE_MQTT_CONNECT,
+    CC_STAGE_NUM
+};
+
+static const CC_Stage_t connectStages[CC_STAGE_NUM] =
+{
+    [CC_STAGE_CONFIG]           = { "config_fetched",   stage_fetch_config },
+    [CC_STAGE_MQTT_OPTIONS]     = { "mqtt_options",     stage_mqtt_options },
+    [CC_STAGE_TLS_SETUP]        = { "tls_setup",        stage_tls_setup },
+    [CC_STAGE_NETWORK]          = { "network_ready",    stage_network_ready },
+    [CC_STAGE_SOCKET]           = { "socket_connected", stage_socket_connect },
+    [CC_STAGE_TLS_HANDSHAKE]    = { "tls_handshake",    stage_tls_handshake },
+    [CC_STAGE_MQTT_CONNECT]     = { "mqtt_connack",     stage_mqtt_connect },
+};
+
+//------------------------------------------------------------------------------
+static void trace_stage(const char* name)
+{
+    BOOT_TRACE_MARK(&bootTrace, name);
+}
+
+//------------------------------------------------------------------------------
+// Run the connection stages from firstStage on. On start-up this includes
+// fetching the configuration, a reconnect uses the cached configuration.
+static int do_connect(CC_FSM_t* self,
+                      size_t firstStage,
+                      void (*onDone)(const char* name))
+{
+    for (size_t i = firstStage; i < CC_STAGE_NUM; i++)
+    {
+        const CC_Stage_t* stage = &connectStages[i];
+
+        OS_Error_t ret = stage->run(self);
+        if (ret != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("Connection stage %s failed with code %d",
+                            stage->name, ret);
+            Metrics_add(METRICS_CONNECT_ERRORS, 1);
+
+            // release what has been set up, so the next attempt starts clean
+            if (i > CC_STAGE_TLS_SETUP)
+            {
+                glue_tls_close();
+            }
+            return ret;
+        }
+
+        Debug_LOG_DEBUG("Connection stage %s done", stage->name);
+        if (onDone != NULL)
+        {
+            onDone(stage->name);
+        }
+    }
+
+    self->isConnected = true;
+    Metrics_add(METRICS_CONNECTS, 1);
+    Metrics_set(METRICS_CONNECTED, 1);
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// Compare the CA certificate in the cache with the parsed one in serverCert,
+// which is followed by zeros.
+static bool is_ca_cert_changed(void)
+{
+    const void* value;
+    size_t valueSize;
+
+    OS_Error_t err = ConfigCache_getParameterPtr(
+                         &configCache,
+                         CONFIG_CLOUD_CONNECTOR_SERVER_CA_CERT_NAME,
+                         &value,
+                         &valueSize);
+    if (err != OS_SUCCESS)
+    {
+        return true;
+    }
+
+    return (valueSize >= sizeof(serverCert))
+           || (memcmp(value, serverCert, valueSize) != 0)
+           || (serverCert[valueSize] != '\0');
+}
+
+//------------------------------------------------------------------------------
+// Fetch the parameters of the domain again if they have changed. They are
+// used when the connection to the cloud is set up the next time. Parsing the
+// CA certificate is slow, so it is only done again if its bytes have changed.
+static void check_config_update(CC_FSM_t* self)
+{
+    if (!ConfigSnapshot_hasDomainChanged(&configSnapshot,
+                                         DOMAIN_CLOUDCONNECTOR,
+                                         &self->configVersion))
+    {
+        return;
+    }
+
+    Debug_LOG_INFO("Configuration of %s changed", DOMAIN_CLOUDCONNECTOR);
+
+    OS_Error_t err = fetch_config();
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("fetch_config() failed with: %d", err);
+        // try again with the next message
+        self->configVersion = 0;
+        self->hasCaCert = false;
+        return;
+    }
+
+    if (self->hasCaCert && is_ca_cert_changed())
+    {
+        Debug_LOG_INFO("Parameter %s changed",
+                       CONFIG_CLOUD_CONNECTOR_SERVER_CA_CERT_NAME);
+        self->hasCaCert = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Keep a copy of a sensor message until the connection to the cloud is up.
+// Must be called with fsmMutex locked.
+static void queue_message(
+    CC_FSM_t*               self,
+    const void*             msg,
+    const CC_MsgTrace_t*    msgTrace)
+{
+    size_t idx;
+
+    if (self->preConnect.count == CLOUDCONNECTOR_PRE_CONNECT_QUEUE_SIZE)
+    {
+        // drop the oldest message, the newest readings are more useful
+        idx = self->preConnect.head;
+        self->preConnect.head = (idx + 1) % CLOUDCONNECTOR_PRE_CONNECT_QUEUE_SIZE;
+        self->preConnect.dropped++;
+        Metrics_add(METRICS_QUEUE_DROPPED, 1);
+        Debug_LOG_WARNING("Message queue full, dropped oldest message (%zu so far)",
+                          self->preConnect.dropped);
+    }
+    else
+    {
+        idx = (self->preConnect.head + self->preConnect.count)
+              % CLOUDCONNECTOR_PRE_CONNECT_QUEUE_SIZE;
+        self->preConnect.count++;
+    }
+
+    memcpy(self->preConnect.msg[idx], msg, sizeof(self->preConnect.msg[idx]));
+    self->preConnect.msgTrace[idx] = *msgTrace;
+    Metrics_set(METRICS_QUEUE_DEPTH, self->preConnect.count);
+}
+
+//------------------------------------------------------------------------------
+static int handle_CC_FSM_NEW_MESSAGE(
+    CC_FSM_t*               self,
+    const void*             msg,
+    const CC_MsgTrace_t*    msgTrace);
+
+//------------------------------------------------------------------------------
+// Send the queued messages in order as one batch. If the connection fails, the
+// remaining messages are kept for the next connection, invalid messages are
+// dropped. Must be called with fsmMutex locked.
+static int flush_queue(CC_FSM_t* self)
+{
+    if (0 == self->preConnect.count)
+    {
+        return 0;
+    }
+
+    Debug_LOG_INFO("Sending %zu queued messages", self->preConnect.count);
+
+    while (self->preConnect.count > 0)
+    {
+        int ret = handle_CC_FSM_NEW_MESSAGE(
+                      self,
+                      self->preConnect.msg[self->preConnect.head],
+                      &self->preConnect.msgTrace[self->preConnect.head]);
+        if ((ret != 0) && !self->isConnected)
+        {
+            Debug_LOG_ERROR("handle_CC_FSM_NEW_MESSAGE() failed with %d, "
+                            "%zu messages kept", ret, self->preConnect.count);
+            return ret;
+        }
+        if (ret != 0)
+        {
+            Debug_LOG_WARNING("Dropping invalid queued message");
+        }
+
+        self->preConnect.head = (self->preConnect.head + 1)
+                                % CLOUDCONNECTOR_PRE_CONNECT_QUEUE_SIZE;
+        self->preConnect.count--;
+        Metrics_set(METRICS_QUEUE_DEPTH, self->preConnect.count);
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// Publish the metrics once MetricsInterval seconds have passed since they were
+// published last, 0 turns it off. They are published with QoS 0, so they cost
+// no round trip and can stay corked. Must be called with fsmMutex locked while
+// connected.
+static void publish_metrics(CC_FSM_t* self)
+{
+    static char payload[Metrics_FORMAT_SIZE];
+
+    int32_t intervalS;
+    OS_Error_t err = ConfigParams_CloudConnector_MetricsInterval(&configCache,
+                                                                 &intervalS);
+    if ((err != OS_SUCCESS) || (intervalS <= 0))
+    {
+        return;
+    }
+
+    uint64_t nowS;
+    err = TimeServer_getTime(&timer, TimeServer_PRECISION_SEC, &nowS);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("TimeServer_getTime() failed with: %d", err);
+        return;
+    }
+
+    if ((nowS - self->metricsPublishedS) < (uint64_t)intervalS)
+    {
+        return;
+    }
+    // a failed attempt is not repeated before the next interval either
+    self->metricsPublishedS = nowS;
+
+    // the last byte is never written, so the topic is always terminated
+    err = ConfigParams_CloudConnector_MetricsTopic(&configCache,
+                                                   metricsTopic,
+                                                   sizeof(metricsTopic) - 1);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("Reading param %s failed with :%d",
+                        CONFIG_CLOUD_CONNECTOR_METRICS_TOPIC_NAME, err);
+        return;
+    }
+
+    size_t len = Metrics_format(payload, sizeof(payload));
+    if (0 == len)
+    {
+        Debug_LOG_ERROR("Metrics_format() failed, buffer too small");
+        return;
+    }
+
+    MQTT_message_t msg =
+    {
+        .qos        = 0,
+        .payload    = payload,
+        .payloadlen = len,
+    };
+
+    int ret = MQTT_client_publish(&(self->paho.client), metricsTopic, &msg,
+                                  NULL);
+    if (ret != MQTT_SUCCESS)
+    {
+        Debug_LOG_ERROR("MQTT_client_publish() of the metrics failed with "
+                        "code %d", ret);
+        Metrics_add(METRICS_PUBLISH_ERRORS, 1);
+        MQTT_client_disconnect(&self->paho.client);
+        glue_tls_close();
+        self->isConnected = false;
+        Metrics_set(METRICS_CONNECTED, 0);
+        return;
+    }
+
+    Debug_LOG_DEBUG("Published metrics, %zu bytes", len);
+}
+
+//------------------------------------------------------------------------------
+static int handle_CC_FSM_INIT(CC_FSM_t* self)
+{
+    // the connection is set up without holding the mutex, so the sensor
+    // messages that arrive meanwhile are queued right away
+    int ret = do_connect(self, CC_STAGE_CONFIG, trace_stage);
+
+    fsmMutex_lock();
+
+    // from now on the RPC thread sends the messages itself and reconnects if
+    // the connection could not be set up here
+    self->isInitialized = true;
+
+    if (ret != 0)
+    {
+        fsmMutex_unlock();
+        Debug_LOG_ERROR("do_connect() failed with code %d", ret);
         return ret;
     }
 
     Debug_LOG_INFO("CloudConnector initialized" );
 
-    //Unblock the cloudConnector_rpc_write
-    ret = sem_post();
+    ret = flush_queue(self);
+
+    fsmMutex_unlock();
+
     if (ret != 0)
     {
-        Debug_LOG_ERROR("sem_post() failed with code %d", ret);
+        Debug_LOG_ERROR("flush_queue() failed with code %d", ret);
         return ret;
     }
 
@@ -457,16 +938,23 @@ static int handle_CC_FSM_INIT(CC_FSM_t* self)
 }
 
 //------------------------------------------------------------------------------
-static int handle_CC_FSM_NEW_MESSAGE(CC_FSM_t* self)
+static int handle_CC_FSM_NEW_MESSAGE(
+    CC_FSM_t*               self,
+    const void*             msg,
+    const CC_MsgTrace_t*    msgTrace)
 {
-    const char* receivedBuf = (const char*) sensor_port;
     CC_FSM_PAHO_NetCtx_t* netCtx_server = &(self->paho.server_netCtx);
 
     Debug_LOG_INFO("New message received from client", __func__);
 
-    memcpy(netCtx_server->readBuff, receivedBuf, sizeof(netCtx_server->readBuff));
+    // the tracepoints down to the TLS layer and the PUBACK get the trace id
+    self->msgTrace = *msgTrace;
+    TRACE_SET_ID(msgTrace->id);
+
+    memcpy(netCtx_server->readBuff, msg, sizeof(netCtx_server->readBuff));
 
     int packet_type = MQTTServer_readType(&self->paho.server);
+    TRACE_POINT(CC_MESSAGE_RX, msgTrace->id, packet_type);
 
     int ret;
     switch (packet_type)
@@ -512,14 +1000,9 @@ static int handle_CC_FSM_NEW_MESSAGE(CC_FSM_t* self)
         break;
     }
 
-    ret = sem_post();
-    if (ret != 0)
-    {
-        Debug_LOG_ERROR("sem_post() failed with code %d", ret);
-        return ret;
-    }
+    TRACE_SET_ID(0);
 
-    return 0;
+    return ret;
 }
 
 //==============================================================================
@@ -528,20 +1011,12 @@ static int handle_CC_FSM_NEW_MESSAGE(CC_FSM_t* self)
 
 
 //------------------------------------------------------------------------------
+// Called from post_init(), before the RPC thread queues the first message. The
+// FSM is static and starts zeroed, so only the Paho contexts are set up.
 int CC_FSM_ctor()
 {
     CC_FSM_t* self = &cc_fsm;
 
-    // Initialize the memory in self
-    memset(self, 0, sizeof(*self));
-
-    OS_Error_t err = init_config_handle(&hConfig);
-    if (err != OS_SUCCESS)
-    {
-        Debug_LOG_ERROR("init_config_handle() failed with: %d", err);
-        return -1;
-    }
-
     //--------------------------------------------------------------------------
     // Setup PAHO MQTT
     //--------------------------------------------------------------------------
@@ -577,18 +1052,96 @@ int CC_FSM_ctor()
 }
 
 OS_Error_t
-cloudConnector_rpc_write()
+cloudConnector_rpc_write(
+    unsigned int    traceId,
+    uint64_t        sampleTimeNs)
 {
     CC_FSM_t* self = &cc_fsm;
+    const CC_MsgTrace_t msgTrace =
+    {
+        .id             = traceId,
+        .sampleTimeNs   = sampleTimeNs,
+    };
 
-    OS_Error_t ret = sem_wait();
-    if (ret)
+    TRACE_POINT(CC_RPC_RX, traceId, Trace_getElapsedUs(sampleTimeNs));
+    Metrics_add(METRICS_MESSAGES, 1);
+
+    int ret = fsmMutex_lock();
+    if (ret != 0)
     {
-        Debug_LOG_ERROR("Failed to wait on semaphore, error %d", ret);
+        Debug_LOG_ERROR("Failed to lock mutex, error %d", ret);
+        return OS_ERROR_GENERIC;
     }
 
-    ret = handle_CC_FSM_NEW_MESSAGE(self);
-    if (ret != OS_SUCCESS)
+    if (!self->isInitialized)
+    {
+        // run() is still connecting, the message is sent once it is done
+        queue_message(self, (const void*)sensor_port, &msgTrace);
+        fsmMutex_unlock();
+        return OS_SUCCESS;
+    }
+
+    check_config_update(self);
+
+    if (!self->isConnected)
+    {
+        Debug_LOG_INFO("Reconnecting to the cloud...");
+        Metrics_add(METRICS_RECONNECTS, 1);
+        TRACE_POINT(CC_RECONNECT, self->preConnect.count);
+        ret = do_connect(self,
+                         self->hasConfig ? CC_STAGE_MQTT_OPTIONS : CC_STAGE_CONFIG,
+                         NULL);
+        if (ret != 0)
+        {
+            Debug_LOG_ERROR("do_connect() failed, message queued");
+            queue_message(self, (const void*)sensor_port, &msgTrace);
+            fsmMutex_unlock();
+            return OS_ERROR_GENERIC;
+        }
+    }
+
+    // the queued messages are older, so they go first
+    ret = flush_queue(self);
+    if (ret != 0)
+    {
+        queue_message(self, (const void*)sensor_port, &msgTrace);
+        fsmMutex_unlock();
+        return OS_ERROR_GENERIC;
+    }
+
+    // metrics that are due are collected with the message and go in one TLS
+    // record with it when its PUBACK is read
+    glue_tls_cork();
+    publish_metrics(self);
+    if (!self->isConnected)
+    {
+        queue_message(self, (const void*)sensor_port, &msgTrace);
+        fsmMutex_unlock();
+        return OS_ERROR_GENERIC;
+    }
+
+    ret = handle_CC_FSM_NEW_MESSAGE(self, (const void*)sensor_port,
+                                    &msgTrace);
+    if ((ret != 0) && !self->isConnected)
+    {
+        // the connection was lost, send the message with the next one
+        queue_message(self, (const void*)sensor_port, &msgTrace);
+    }
+
+    // sends the metrics if the message did not go to the cloud
+    if (self->isConnected
+        && (glue_tls_uncork(PAHO_TIMEOUT_MS_COMMAND) != MQTT_SUCCESS))
+    {
+        Debug_LOG_ERROR("glue_tls_uncork() failed, closing the connection");
+        MQTT_client_disconnect(&self->paho.client);
+        glue_tls_close();
+        self->isConnected = false;
+        Metrics_set(METRICS_CONNECTED, 0);
+    }
+
+    fsmMutex_unlock();
+
+    if (ret != 0)
     {
         Debug_LOG_ERROR("handle_CC_FSM_NEW_MESSAGE() failed with %d", ret);
         return OS_ERROR_GENERIC;
@@ -600,22 +1153,50 @@ cloudConnector_rpc_write()
 }
 
 //------------------------------------------------------------------------------
-
-int run()
+OS_Error_t
+cloudConnector_rpc_getMetrics(
+    unsigned int* size)
 {
-    Debug_LOG_INFO("Starting CloudConnector...");
+    // the caller is blocked in this call, so it does not use the dataport
+    size_t len = Metrics_format((char*)sensor_port, Metrics_FORMAT_SIZE);
+    if (0 == len)
+    {
+        Debug_LOG_ERROR("Metrics_format() failed, buffer too small");
+        return OS_ERROR_BUFFER_TOO_SMALL;
+    }
 
-    CC_FSM_t* self = &cc_fsm;
+    *size = len;
 
+    return OS_SUCCESS;
+}
 
+//------------------------------------------------------------------------------
+// The RPC interface starts serving after this, so the FSM is set up before a
+// message can be queued.
+void post_init(void)
+{
     int ret = CC_FSM_ctor();
     if (ret != 0)
     {
         Debug_LOG_ERROR("CC_FSM_ctor() failed with: %d", ret);
-        return -1;
     }
+}
+
+//------------------------------------------------------------------------------
+
+int run()
+{
+    BOOT_TRACE_MARK(&bootTrace, "run");
+    TRACE_INIT(trace_port, &timer);
+    Debug_LOG_INFO("Starting CloudConnector...");
+
+    CC_FSM_t* self = &cc_fsm;
+
+#if defined(MQTT_BENCHMARK)
+    MQTT_bench_run();
+#endif
 
-    ret = handle_CC_FSM_INIT(self);
+    int ret = handle_CC_FSM_INIT(self);
     if (ret != 0)
     {
         Debug_LOG_ERROR("handle_CC_FSM_INIT() failed with: %d", ret);
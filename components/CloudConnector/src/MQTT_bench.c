@@ -0,0 +1,495 @@
+/*
+ * MQTT codec microbenchmarks
+ *
+ * Measures the MQTT functions that are executed for every message passing the
+ * CloudConnector and compares the remaining length decoder used in MQTT_net.c
+ * with alternative implementations. The results are logged as ns/op and
+ * bytes/op, where bytes/op is the amount of data produced or consumed by one
+ * operation.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "MQTT_bench.h"
+
+#include "MQTT_net.h"
+#include "MQTTPacket.h"
+
+#include "lib_debug/Debug.h"
+#include "lib_debug/Debug_OS_Error.h"
+#include "TimeServer.h"
+
+#include <string.h>
+#include <camkes.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define BENCH_BUFFER_SIZE       1024
+#define BENCH_MAX_TOPIC_LEN     128
+#define BENCH_MAX_PAYLOAD_LEN   512
+
+#define BENCH_PACKET_ID         1
+
+#define BENCH_ARRAY_SIZE(_a_)   (sizeof(_a_) / sizeof((_a_)[0]))
+
+//------------------------------------------------------------------------------
+static const if_OS_Timer_t timer =
+    IF_OS_TIMER_ASSIGN(
+        timeServer_rpc,
+        timeServer_notify);
+
+// The first topic and payload sizes match the demo configuration, the others
+// cover longer device specific topics and bigger sensor readings.
+static const size_t topicSizes[]   = { 35, 64, BENCH_MAX_TOPIC_LEN };
+static const size_t payloadSizes[] = { 26, 128, BENCH_MAX_PAYLOAD_LEN };
+
+// Remaining length values at the boundaries of the 1 to 4 byte encodings.
+static const unsigned int lengthValues[] =
+{
+    0, 127, 128, 16383, 16384, 2097151, 2097152, 268435455
+};
+
+static char          bufTopic[BENCH_MAX_TOPIC_LEN + 1];
+static unsigned char bufPayload[BENCH_MAX_PAYLOAD_LEN];
+static unsigned char bufPacket[BENCH_BUFFER_SIZE];
+static unsigned char bufRead[BENCH_BUFFER_SIZE];
+
+// Results are accumulated here, so the compiler can't drop the measured work.
+static volatile unsigned int sink;
+
+// Network backend that reads from memory. The Network object has no context
+// pointer, so the state is kept here.
+static struct
+{
+    const unsigned char* data;
+    size_t               len;
+    size_t               pos;
+} memNet;
+
+
+//==============================================================================
+// helper functions
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static uint64_t
+getTimeNs(void)
+{
+    uint64_t ns;
+
+    OS_Error_t err = TimeServer_getTime(
+                         &timer,
+                         TimeServer_PRECISION_NSEC,
+                         &ns);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("TimeServer_getTime() failed , code '%s'",
+                        Debug_OS_Error_toString(err));
+        ns = 0;
+    }
+
+    return ns;
+}
+
+//------------------------------------------------------------------------------
+static void
+report(
+    const char* name,
+    size_t      sizeA,
+    size_t      sizeB,
+    uint64_t    start,
+    uint64_t    end,
+    size_t      bytesPerOp)
+{
+    unsigned long long nsPerOp = (end - start) / MQTT_BENCH_ITERATIONS;
+
+    Debug_LOG_INFO("bench %-26s %9zu %4zu: %8llu ns/op %5zu bytes/op",
+                   name, sizeA, sizeB, nsPerOp, bytesPerOp);
+}
+
+//------------------------------------------------------------------------------
+static int
+memNet_read(
+    Network* n,
+    unsigned char* buf,
+    int len,
+    int timeout_ms)
+{
+    if ((len < 0) || ((memNet.pos + len) > memNet.len))
+    {
+        return MQTT_FAILURE;
+    }
+
+    memcpy(buf, &memNet.data[memNet.pos], len);
+    memNet.pos += len;
+
+    return MQTT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static int
+memNet_write(
+    Network* n,
+    const unsigned char* buf,
+    int len,
+    int timeout_ms)
+{
+    return MQTT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static void
+memNet_reset(
+    const unsigned char* data,
+    size_t len)
+{
+    memNet.data = data;
+    memNet.len  = len;
+    memNet.pos  = 0;
+}
+
+//------------------------------------------------------------------------------
+static int
+serializePublish(
+    size_t topicLen,
+    size_t payloadLen)
+{
+    memset(bufTopic, 't', topicLen);
+    bufTopic[topicLen] = '\0';
+
+    MQTTString topic = MQTTString_initializer;
+    topic.cstring = bufTopic;
+
+    return MQTTSerialize_publish(bufPacket,
+                                 sizeof(bufPacket),
+                                 0,
+                                 1,
+                                 0,
+                                 BENCH_PACKET_ID,
+                                 topic,
+                                 bufPayload,
+                                 payloadLen);
+}
+
+
+//==============================================================================
+// remaining length decoders
+//==============================================================================
+
+//------------------------------------------------------------------------------
+// Same algorithm as MQTT_network_readAndDecodePacketLength(), which does one
+// call into the network layer per length byte.
+static int
+decode_bytewise(
+    Network* n,
+    unsigned int* value)
+{
+    unsigned int tmpLen = 0;
+    int shift = 0;
+
+    for (int cnt = 1; cnt <= 4; cnt++)
+    {
+        unsigned char lenByte;
+        int rc = MQTT_network_read(n, &lenByte, 1, NULL);
+        if (rc != MQTT_SUCCESS)
+        {
+            return rc;
+        }
+
+        tmpLen |= (lenByte & 0x7fU) << shift;
+        shift += 7;
+
+        if ((lenByte & 0x80U) == 0)
+        {
+            *value = tmpLen;
+            return cnt;
+        }
+    }
+
+    return MQTT_FAILURE;
+}
+
+//------------------------------------------------------------------------------
+// Same loop, but operating on a buffer that holds the length bytes already.
+static int
+decode_loop(
+    const unsigned char* buf,
+    unsigned int* value)
+{
+    unsigned int tmpLen = 0;
+    int shift = 0;
+
+    for (int cnt = 1; cnt <= 4; cnt++)
+    {
+        unsigned char lenByte = buf[cnt - 1];
+
+        tmpLen |= (lenByte & 0x7fU) << shift;
+        shift += 7;
+
+        if ((lenByte & 0x80U) == 0)
+        {
+            *value = tmpLen;
+            return cnt;
+        }
+    }
+
+    return MQTT_FAILURE;
+}
+
+//------------------------------------------------------------------------------
+// Table driven variant without data dependent branches. All four possible
+// length bytes are loaded at once, the first byte with bit 7 cleared gives
+// the number of length bytes and the table the mask for the valid value bits.
+// The buffer must have at least 4 readable bytes.
+static const uint32_t decodeMask[] =
+{
+    0x0000007f, 0x00003fff, 0x001fffff, 0x0fffffff
+};
+
+static int
+decode_table(
+    const unsigned char* buf,
+    unsigned int* value)
+{
+    uint32_t x = (uint32_t)buf[0]
+                 | ((uint32_t)buf[1] << 8)
+                 | ((uint32_t)buf[2] << 16)
+                 | ((uint32_t)buf[3] << 24);
+
+    uint32_t stopBits = ~x & 0x80808080U;
+    if (stopBits == 0)
+    {
+        return MQTT_FAILURE;
+    }
+
+    unsigned int idx = ((unsigned int)__builtin_ctz(stopBits)) >> 3;
+
+    uint32_t tmpLen = (x & 0x0000007fU)
+                      | ((x >> 1) & 0x00003f80U)
+                      | ((x >> 2) & 0x001fc000U)
+                      | ((x >> 3) & 0x0fe00000U);
+
+    *value = tmpLen & decodeMask[idx];
+    return idx + 1;
+}
+
+
+//==============================================================================
+// benchmarks
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void
+bench_serializePublish(
+    size_t topicLen,
+    size_t payloadLen)
+{
+    int len = serializePublish(topicLen, payloadLen);
+    if (len <= 0)
+    {
+        Debug_LOG_ERROR("MQTTSerialize_publish() failed with code %d", len);
+        return;
+    }
+
+    MQTTString topic = MQTTString_initializer;
+    topic.cstring = bufTopic;
+
+    uint64_t start = getTimeNs();
+    for (unsigned int i = 0; i < MQTT_BENCH_ITERATIONS; i++)
+    {
+        sink += MQTTSerialize_publish(bufPacket,
+                                      sizeof(bufPacket),
+                                      0,
+                                      1,
+                                      0,
+                                      BENCH_PACKET_ID,
+                                      topic,
+                                      bufPayload,
+                                      payloadLen);
+    }
+    uint64_t end = getTimeNs();
+
+    report("MQTTSerialize_publish", topicLen, payloadLen, start, end, len);
+}
+
+//------------------------------------------------------------------------------
+static void
+bench_deserializePublish(
+    size_t topicLen,
+    size_t payloadLen)
+{
+    int len = serializePublish(topicLen, payloadLen);
+    if (len <= 0)
+    {
+        Debug_LOG_ERROR("MQTTSerialize_publish() failed with code %d", len);
+        return;
+    }
+
+    unsigned char dup;
+    int qos;
+    unsigned char retained;
+    unsigned short id;
+    MQTTString topic;
+    unsigned char* payload;
+    int payloadLenOut;
+
+    uint64_t start = getTimeNs();
+    for (unsigned int i = 0; i < MQTT_BENCH_ITERATIONS; i++)
+    {
+        sink += MQTTDeserialize_publish(&dup,
+                                        &qos,
+                                        &retained,
+                                        &id,
+                                        &topic,
+                                        &payload,
+                                        &payloadLenOut,
+                                        bufPacket,
+                                        len);
+    }
+    uint64_t end = getTimeNs();
+
+    report("MQTTDeserialize_publish", topicLen, payloadLen, start, end, len);
+}
+
+//------------------------------------------------------------------------------
+static void
+bench_readPacket(
+    size_t topicLen,
+    size_t payloadLen)
+{
+    int len = serializePublish(topicLen, payloadLen);
+    if (len <= 0)
+    {
+        Debug_LOG_ERROR("MQTTSerialize_publish() failed with code %d", len);
+        return;
+    }
+
+    Network net = { .mqttread = memNet_read, .mqttwrite = memNet_write };
+
+    uint64_t start = getTimeNs();
+    for (unsigned int i = 0; i < MQTT_BENCH_ITERATIONS; i++)
+    {
+        memNet_reset(bufPacket, len);
+        sink += MQTT_network_readPacket(&net,
+                                        bufRead,
+                                        sizeof(bufRead),
+                                        NULL);
+    }
+    uint64_t end = getTimeNs();
+
+    report("MQTT_network_readPacket", topicLen, payloadLen, start, end, len);
+}
+
+//------------------------------------------------------------------------------
+static void
+bench_deserializeAck(void)
+{
+    int len = MQTTSerialize_puback(bufPacket, sizeof(bufPacket), BENCH_PACKET_ID);
+    if (len <= 0)
+    {
+        Debug_LOG_ERROR("MQTTSerialize_puback() failed with code %d", len);
+        return;
+    }
+
+    unsigned char type;
+    unsigned char dup;
+    unsigned short id;
+
+    uint64_t start = getTimeNs();
+    for (unsigned int i = 0; i < MQTT_BENCH_ITERATIONS; i++)
+    {
+        sink += MQTTDeserialize_ack(&type, &dup, &id, bufPacket, len);
+    }
+    uint64_t end = getTimeNs();
+
+    report("MQTTDeserialize_ack", 0, 0, start, end, len);
+}
+
+//------------------------------------------------------------------------------
+static void
+bench_remainingLength(
+    unsigned int value)
+{
+    // keep 4 readable bytes behind the encoding for decode_table()
+    memset(bufPacket, 0, sizeof(bufPacket));
+    int len = MQTTPacket_encode(bufPacket, value);
+
+    uint64_t start = getTimeNs();
+    for (unsigned int i = 0; i < MQTT_BENCH_ITERATIONS; i++)
+    {
+        sink += MQTTPacket_encode(bufRead, value);
+    }
+    uint64_t end = getTimeNs();
+    report("MQTTPacket_encode", value, len, start, end, len);
+
+    Network net = { .mqttread = memNet_read, .mqttwrite = memNet_write };
+    unsigned int decoded = 0;
+
+    start = getTimeNs();
+    for (unsigned int i = 0; i < MQTT_BENCH_ITERATIONS; i++)
+    {
+        memNet_reset(bufPacket, len);
+        sink += decode_bytewise(&net, &decoded);
+    }
+    end = getTimeNs();
+    Debug_ASSERT(decoded == value);
+    report("decode_bytewise (current)", value, len, start, end, len);
+
+    start = getTimeNs();
+    for (unsigned int i = 0; i < MQTT_BENCH_ITERATIONS; i++)
+    {
+        sink += decode_loop(bufPacket, &decoded);
+    }
+    end = getTimeNs();
+    Debug_ASSERT(decoded == value);
+    report("decode_loop", value, len, start, end, len);
+
+    start = getTimeNs();
+    for (unsigned int i = 0; i < MQTT_BENCH_ITERATIONS; i++)
+    {
+        sink += decode_table(bufPacket, &decoded);
+    }
+    end = getTimeNs();
+    Debug_ASSERT(decoded == value);
+    report("decode_table", value, len, start, end, len);
+}
+
+
+//==============================================================================
+// public functions
+//==============================================================================
+
+//------------------------------------------------------------------------------
+void
+MQTT_bench_run(void)
+{
+    Debug_LOG_INFO("Running MQTT benchmarks, %u iterations each...",
+                   MQTT_BENCH_ITERATIONS);
+
+    for (size_t i = 0; i < sizeof(bufPayload); i++)
+    {
+        bufPayload[i] = (unsigned char)('0' + (i % 10));
+    }
+
+    for (size_t t = 0; t < BENCH_ARRAY_SIZE(topicSizes); t++)
+    {
+        for (size_t p = 0; p < BENCH_ARRAY_SIZE(payloadSizes); p++)
+        {
+            bench_serializePublish(topicSizes[t], payloadSizes[p]);
+            bench_deserializePublish(topicSizes[t], payloadSizes[p]);
+            bench_readPacket(topicSizes[t], payloadSizes[p]);
+        }
+    }
+
+    bench_deserializeAck();
+
+    for (size_t i = 0; i < BENCH_ARRAY_SIZE(lengthValues); i++)
+    {
+        bench_remainingLength(lengthValues[i]);
+    }
+
+    Debug_LOG_INFO("MQTT benchmarks done");
+}
@@ -0,0 +1,21 @@
+/*
+ * MQTT codec microbenchmarks
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+// Number of iterations per benchmark case. The time is taken only once for
+// all iterations, so the TimeServer RPC overhead is amortized.
+#if !defined(MQTT_BENCH_ITERATIONS)
+#define MQTT_BENCH_ITERATIONS   10000
+#endif
+
+// Run all MQTT serialization/deserialization and remaining length coding
+// benchmarks and log the results as ns/op and bytes/op.
+void MQTT_bench_run(void);
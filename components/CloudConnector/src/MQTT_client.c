@@ -15,6 +15,8 @@
 #include "lib_compiler/compiler.h"
 #include "lib_debug/Debug.h"
 
+#include "trace.h"
+
 #define MAX_PACKET_ID   65535 // according to the MQTT specification
 
 
@@ -221,6 +223,7 @@ static int sendPublish(
                         len);
         return MQTT_FAILURE;
     }
+    TRACE_POINT(CC_PUBLISH_SERIALIZED, Trace_getId(), len);
 
     int ret = sendPacket(self, len);
     if (ret != MQTT_SUCCESS)
@@ -416,6 +419,7 @@ int checkPublishQos(
         }
 
         Debug_ASSERT(PUBACK == ackData.type);
+        TRACE_POINT(CC_PUBACK, Trace_getId(), ackData.packetId);
         Debug_LOG_INFO("%s(): got PUBACK", __func__);
 
         return MQTT_SUCCESS;
@@ -9,8 +9,10 @@
  */
 
 #include "glue_tls_mqtt.h"
+#include "metrics.h"
 
 #include "TimeServer.h"
+#include "trace.h"
 #include "lib_debug/Debug_OS_Error.h"
 
 #include <camkes.h>
@@ -28,6 +30,18 @@ static OS_Tls_Handle_t tlsContext;
 static OS_Crypto_Handle_t hCrypto;
 static OS_Socket_Handle_t socketHandle;
 
+// the crypto and TLS contexts are kept across connections, so the CA
+// certificates are parsed only once
+static bool isSetUp;
+
+// MQTT packets written while corked, they are sent as one TLS record
+static struct
+{
+    bool            isCorked;
+    size_t          len;
+    unsigned char   buf[CLOUDCONNECTOR_TLS_CORK_SIZE];
+} cork;
+
 static OS_Tls_Config_t tlsCfg =
 {
     .mode = OS_Tls_MODE_LIBRARY,
@@ -52,32 +66,6 @@ static OS_Crypto_Config_t cryptoCfg =
 };
 
 // Private static functions ----------------------------------------------------
-static OS_Error_t
-waitForNetworkStackInit(
-    const if_OS_Socket_t* const ctx)
-{
-    OS_NetworkStack_State_t networkStackState;
-
-    for (;;)
-    {
-        networkStackState = OS_Socket_getStatus(ctx);
-        if (networkStackState == RUNNING)
-        {
-            // NetworkStack up and running.
-            return OS_SUCCESS;
-        }
-        else if (networkStackState == FATAL_ERROR)
-        {
-            // NetworkStack will not come up.
-            Debug_LOG_ERROR("A FATAL_ERROR occurred in the Network Stack component.");
-            return OS_ERROR_ABORTED;
-        }
-
-        // Yield to wait until the stack is up and running.
-        seL4_Yield();
-    }
-}
-
 static OS_Error_t
 connectSocket(
     OS_Socket_Handle_t* const socketHandle,
@@ -208,12 +196,17 @@ connectSocket(
 
 //------------------------------------------------------------------------------
 OS_Error_t
-glue_tls_init(
-    const char* serverIpAddress,
-    const char* caCert,
-    size_t caCertSize,
-    uint32_t serverPort)
+glue_tls_setup(
+    const char* caCert)
 {
+    if (isSetUp)
+    {
+        Metrics_add(METRICS_TLS_REUSES, 1);
+        return OS_SUCCESS;
+    }
+
+    const uint64_t startUs = glue_tls_mqtt_getTimeUs();
+
     OS_Error_t ret = OS_Crypto_init(&hCrypto, &cryptoCfg);
     if (ret != OS_SUCCESS)
     {
@@ -231,17 +224,49 @@ glue_tls_init(
     if (ret != OS_SUCCESS)
     {
         Debug_LOG_ERROR("OS_Tls_init() failed with: %d", ret);
+        OS_Crypto_free(hCrypto);
         return ret;
     }
+    isSetUp = true;
 
-    // Check and wait until the NetworkStack component is up and running.
-    ret = waitForNetworkStackInit(&networkStackCtx);
-    if (OS_SUCCESS != ret)
+    Metrics_observe(METRICS_TLS_SETUP,
+                    (uint32_t)(glue_tls_mqtt_getTimeUs() - startUs));
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+glue_tls_waitForNetworkStack(void)
+{
+    for (;;)
     {
-        Debug_LOG_ERROR("waitForNetworkStackInit() failed with: %d", ret);
-        return ret;
+        OS_NetworkStack_State_t networkStackState =
+            OS_Socket_getStatus(&networkStackCtx);
+
+        if (networkStackState == RUNNING)
+        {
+            // NetworkStack up and running.
+            return OS_SUCCESS;
+        }
+        else if (networkStackState == FATAL_ERROR)
+        {
+            // NetworkStack will not come up.
+            Debug_LOG_ERROR("A FATAL_ERROR occurred in the Network Stack component.");
+            return OS_ERROR_ABORTED;
+        }
+
+        // Yield to wait until the stack is up and running.
+        seL4_Yield();
     }
+}
 
+//------------------------------------------------------------------------------
+OS_Error_t
+glue_tls_connect(
+    const char* serverIpAddress,
+    uint32_t serverPort)
+{
     OS_Socket_Addr_t dstAddr;
 
     strncpy(dstAddr.addr, serverIpAddress, sizeof(dstAddr.addr));
@@ -249,13 +274,16 @@ glue_tls_init(
 
     dstAddr.port = serverPort;
 
-    ret = connectSocket(&socketHandle, &dstAddr);
+    const uint64_t startUs = glue_tls_mqtt_getTimeUs();
+    OS_Error_t ret = connectSocket(&socketHandle, &dstAddr);
     if (OS_SUCCESS != ret)
     {
         Debug_LOG_ERROR("connectSocket() failed with err %d", ret);
         return ret;
     }
 
+    Metrics_observe(METRICS_TCP_CONNECT,
+                    (uint32_t)(glue_tls_mqtt_getTimeUs() - startUs));
     Debug_LOG_INFO("TCP connection established successfully");
 
     return OS_SUCCESS;
@@ -265,59 +293,180 @@ glue_tls_init(
 OS_Error_t
 glue_tls_handshake(void)
 {
+    // the TLS library does the socket I/O of the handshake itself, so it can
+    // only be timed as a whole
+    const uint64_t startUs = glue_tls_mqtt_getTimeUs();
     OS_Error_t ret = OS_Tls_handshake(tlsContext);
     if (ret != OS_SUCCESS)
     {
         Debug_LOG_ERROR("OS_Tls_handshake() failed with: %d", ret);
         return ret;
     }
+    Metrics_observe(METRICS_TLS_HANDSHAKE,
+                    (uint32_t)(glue_tls_mqtt_getTimeUs() - startUs));
 
     return OS_SUCCESS;
 }
 
+//------------------------------------------------------------------------------
+// End the TLS session and close the socket. The TLS context is reset and kept
+// with the parsed CA certificates for the next connection, if that fails it is
+// released and glue_tls_setup() creates a new one.
+OS_Error_t
+glue_tls_close(void)
+{
+    // whatever is corked can't be sent anymore
+    cork.isCorked = false;
+    cork.len = 0;
+
+    OS_Error_t ret = OS_Tls_reset(tlsContext);
+    if (ret != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_Tls_reset() failed with: %d", ret);
+    }
+
+    OS_Error_t err = OS_Socket_close(socketHandle);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_Socket_close() failed with: %d", err);
+        ret = (ret == OS_SUCCESS) ? err : ret;
+    }
+
+    if (ret != OS_SUCCESS)
+    {
+        glue_tls_free();
+    }
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+glue_tls_free(void)
+{
+    if (!isSetUp)
+    {
+        return OS_SUCCESS;
+    }
+    isSetUp = false;
+
+    OS_Error_t ret = OS_Tls_free(tlsContext);
+    if (ret != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_Tls_free() failed with: %d", ret);
+    }
+
+    OS_Error_t err = OS_Crypto_free(hCrypto);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_Crypto_free() failed with: %d", err);
+        ret = (ret == OS_SUCCESS) ? err : ret;
+    }
+
+    return ret;
+}
+
 //------------------------------------------------------------------------------
 uint64_t
-glue_tls_mqtt_getTimeMs(void)
+glue_tls_mqtt_getTimeUs(void)
 {
-    uint64_t ms;
+    uint64_t us;
 
     OS_Error_t err = TimeServer_getTime(
                          &timer,
-                         TimeServer_PRECISION_MSEC,
-                         &ms);
+                         TimeServer_PRECISION_USEC,
+                         &us);
 
     if (err != OS_SUCCESS)
     {
         Debug_LOG_ERROR("TimeServer_getTime() failed , code '%s'",
                         Debug_OS_Error_toString(err));
-        ms = 0;
+        us = 0;
     }
 
-    return ms;
+    return us;
 }
 
 //------------------------------------------------------------------------------
-int glue_tls_mqtt_write(Network* n,
-                        const unsigned char* buf,
-                        int len,
-                        int timeout_ms)
+// The OS_Tls_write() or OS_Tls_read() calls of one glue_tls_mqtt_write() or
+// glue_tls_mqtt_read().
+typedef struct
 {
-    Debug_ASSERT(buf != NULL);
+    uint64_t    entryUs;
+    uint64_t    lastUs;     // end of the previous call
+    uint32_t    calls;
+    uint32_t    spins;      // calls that returned OS_ERROR_WOULD_BLOCK
+    uint64_t    blockedUs;  // time of these calls and their yields
+} IoStats_t;
+
+//------------------------------------------------------------------------------
+// Account a call that has just ended, the time is also the one of the timeout.
+static void
+io_callDone(
+    IoStats_t*  stats,
+    bool        wouldBlock)
+{
+    const uint64_t nowUs = glue_tls_mqtt_getTimeUs();
 
-    const uint64_t entryTime = glue_tls_mqtt_getTimeMs();
-    if (entryTime == 0)
+    stats->calls++;
+    if (wouldBlock)
     {
-        Debug_LOG_ERROR("glue_tls_mqtt_getTimeMs() failed to provide "
+        Metrics_add(METRICS_WOULD_BLOCK, 1);
+        stats->spins++;
+        stats->blockedUs += nowUs - stats->lastUs;
+    }
+    stats->lastUs = nowUs;
+}
+
+//------------------------------------------------------------------------------
+static bool
+io_isTimedOut(
+    const IoStats_t*    stats,
+    int                 timeout_ms)
+{
+    return (stats->lastUs - stats->entryUs) >= ((uint64_t)timeout_ms * 1000);
+}
+
+//------------------------------------------------------------------------------
+// Record a finished glue_tls_mqtt_write() or glue_tls_mqtt_read() in the
+// histograms of its direction.
+static void
+io_record(
+    const IoStats_t*    stats,
+    Metrics_Histogram_t total,
+    Metrics_Histogram_t blocked,
+    Metrics_Histogram_t calls,
+    Metrics_Histogram_t spins)
+{
+    Metrics_observe(total, (uint32_t)(stats->lastUs - stats->entryUs));
+    Metrics_observe(blocked, (uint32_t)stats->blockedUs);
+    Metrics_observe(calls, stats->calls);
+    Metrics_observe(spins, stats->spins);
+}
+
+//------------------------------------------------------------------------------
+// Write buf with as few OS_Tls_write() calls as possible, each of them sends
+// one TLS record.
+static int
+tls_write(
+    const unsigned char*    buf,
+    int                     len,
+    int                     timeout_ms)
+{
+    IoStats_t stats = { .entryUs = glue_tls_mqtt_getTimeUs() };
+    if (stats.entryUs == 0)
+    {
+        Debug_LOG_ERROR("glue_tls_mqtt_getTimeUs() failed to provide "
                         "entry time");
         return MQTT_FAILURE;
     }
+    stats.lastUs = stats.entryUs;
 
     size_t remainingLen = len;
     size_t writtenLen = 0;
 
     // Loop until all data is sent or timeout.
-    while ((remainingLen > 0)
-           && ((glue_tls_mqtt_getTimeMs() - entryTime) < timeout_ms))
+    while ((remainingLen > 0) && !io_isTimedOut(&stats, timeout_ms))
     {
         size_t actualLen = remainingLen;
         OS_Error_t ret = OS_Tls_write(
@@ -329,6 +478,7 @@ int glue_tls_mqtt_write(Network* n,
         case OS_SUCCESS:
             remainingLen -= actualLen;
             writtenLen += actualLen;
+            Metrics_observe(METRICS_TLS_WRITE_BYTES, actualLen);
             break;
         case OS_ERROR_WOULD_BLOCK:
             // Donate the remaining timeslice to a thread of the same priority
@@ -339,8 +489,14 @@ int glue_tls_mqtt_write(Network* n,
             Debug_LOG_ERROR("OS_Tls_write() failed with: %d", ret);
             return MQTT_FAILURE;
         }
+        io_callDone(&stats, (OS_ERROR_WOULD_BLOCK == ret));
     };
 
+    TRACE_POINT(CC_TLS_WRITTEN, Trace_getId(), writtenLen, remainingLen);
+    Metrics_add(METRICS_BYTES_OUT, writtenLen);
+    io_record(&stats, METRICS_TLS_WRITE, METRICS_TLS_WRITE_BLOCKED,
+              METRICS_TLS_WRITE_CALLS, METRICS_TLS_WRITE_SPINS);
+
     if (remainingLen > 0)
     {
         Debug_LOG_ERROR("OS_Tls_write() wrote only %zu bytes (of %d bytes)",
@@ -350,6 +506,75 @@ int glue_tls_mqtt_write(Network* n,
     return MQTT_SUCCESS;
 }
 
+//------------------------------------------------------------------------------
+static int
+cork_flush(
+    int timeout_ms)
+{
+    if (0 == cork.len)
+    {
+        return MQTT_SUCCESS;
+    }
+
+    Metrics_add(METRICS_CORK_FLUSHES, 1);
+
+    int ret = tls_write(cork.buf, cork.len, timeout_ms);
+    cork.len = 0;
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+void
+glue_tls_cork(void)
+{
+    cork.isCorked = true;
+}
+
+//------------------------------------------------------------------------------
+int
+glue_tls_uncork(
+    int timeout_ms)
+{
+    cork.isCorked = false;
+
+    return cork_flush(timeout_ms);
+}
+
+//------------------------------------------------------------------------------
+int glue_tls_mqtt_write(Network* n,
+                        const unsigned char* buf,
+                        int len,
+                        int timeout_ms)
+{
+    Debug_ASSERT(buf != NULL);
+
+    if (!cork.isCorked)
+    {
+        return tls_write(buf, len, timeout_ms);
+    }
+
+    if ((size_t)len > (sizeof(cork.buf) - cork.len))
+    {
+        int ret = cork_flush(timeout_ms);
+        if (ret != MQTT_SUCCESS)
+        {
+            return ret;
+        }
+
+        if ((size_t)len > sizeof(cork.buf))
+        {
+            return tls_write(buf, len, timeout_ms);
+        }
+    }
+
+    memcpy(&cork.buf[cork.len], buf, len);
+    cork.len += len;
+    Metrics_add(METRICS_CORKED_WRITES, 1);
+
+    return MQTT_SUCCESS;
+}
+
 //------------------------------------------------------------------------------
 int glue_tls_mqtt_read(Network* n,
                        unsigned char* buf,
@@ -359,21 +584,29 @@ int glue_tls_mqtt_read(Network* n,
     Debug_ASSERT(buf != NULL);
     Debug_LOG_TRACE("%s: %d bytes, %d ms", __func__, len, timeout_ms);
 
-    const uint64_t entryTime = glue_tls_mqtt_getTimeMs();
-    if (entryTime == 0)
+    // the peer can only answer what it has received
+    int err = cork_flush(timeout_ms);
+    if (err != MQTT_SUCCESS)
     {
-        Debug_LOG_ERROR("glue_tls_mqtt_getTimeMs() failed to provide "
+        Debug_LOG_ERROR("cork_flush() failed with: %d", err);
+        return err;
+    }
+
+    IoStats_t stats = { .entryUs = glue_tls_mqtt_getTimeUs() };
+    if (stats.entryUs == 0)
+    {
+        Debug_LOG_ERROR("glue_tls_mqtt_getTimeUs() failed to provide "
                         "entry time");
         return MQTT_FAILURE;
     }
+    stats.lastUs = stats.entryUs;
 
     size_t remainingLen = len;
     memset(buf, 0, len);
     size_t readLen = 0;
 
     // Loop until all data is read or timeout.
-    while ((remainingLen > 0)
-           && ((glue_tls_mqtt_getTimeMs() - entryTime) < timeout_ms))
+    while ((remainingLen > 0) && !io_isTimedOut(&stats, timeout_ms))
     {
         size_t actualLen = remainingLen;
         OS_Error_t ret = OS_Tls_read(tlsContext, (buf + readLen), &actualLen);
@@ -382,6 +615,7 @@ int glue_tls_mqtt_read(Network* n,
         case OS_SUCCESS:
             remainingLen -= actualLen;
             readLen += actualLen;
+            Metrics_observe(METRICS_TLS_READ_BYTES, actualLen);
             break;
         case OS_ERROR_WOULD_BLOCK:
             // Donate the remaining timeslice to a thread of the same priority
@@ -392,8 +626,13 @@ int glue_tls_mqtt_read(Network* n,
             Debug_LOG_ERROR("OS_Tls_read() failed with: %d", ret);
             return MQTT_FAILURE;
         }
+        io_callDone(&stats, (OS_ERROR_WOULD_BLOCK == ret));
     };
 
+    Metrics_add(METRICS_BYTES_IN, readLen);
+    io_record(&stats, METRICS_TLS_READ, METRICS_TLS_READ_BLOCKED,
+              METRICS_TLS_READ_CALLS, METRICS_TLS_READ_SPINS);
+
     if (remainingLen > 0)
     {
         Debug_LOG_ERROR("OS_Tls_read() read only %zu bytes (of %d bytes)",
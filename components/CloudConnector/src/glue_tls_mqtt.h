@@ -29,17 +29,46 @@
 #include XSTR(MQTTCLIENT_PLATFORM_HEADER)
 #endif
 
+// Set up the crypto and TLS contexts, this does not need the network. The
+// contexts are kept until glue_tls_free(), until then this does nothing and
+// caCert is not parsed again.
 OS_Error_t
-glue_tls_init(const char* ipAddress,
-              const char* caCert,
-              size_t caCertSize,
-              uint32_t port);
+glue_tls_setup(const char* caCert);
+
+// Wait until the NetworkStack is running.
+OS_Error_t
+glue_tls_waitForNetworkStack(void);
+
+// Connect the TCP socket of the TLS session to the server.
+OS_Error_t
+glue_tls_connect(const char* ipAddress,
+                 uint32_t port);
 
 OS_Error_t
 glue_tls_handshake(void);
 
+// End the session and close the socket, the contexts are kept for the next
+// connection.
+OS_Error_t
+glue_tls_close(void);
+
+// Release the contexts, e.g. to set them up with another CA certificate.
+OS_Error_t
+glue_tls_free(void);
+
 uint64_t
-glue_tls_mqtt_getTimeMs(void);
+glue_tls_mqtt_getTimeUs(void);
+
+// Collect the following writes and send them as one TLS record, instead of
+// one record per MQTT packet. They are sent when the buffer is full, before
+// anything is read and with glue_tls_uncork(), so a write that fails shows up
+// in one of these calls.
+void
+glue_tls_cork(void);
+
+// Send what has been collected since glue_tls_cork() and stop collecting.
+int
+glue_tls_uncork(int timeout_ms);
 
 int
 glue_tls_mqtt_write(Network* n,
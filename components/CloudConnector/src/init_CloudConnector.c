@@ -14,22 +14,40 @@
 #include "lib_debug/Debug.h"
 #include "OS_ConfigService.h"
 
+#include "config_cache.h"
+
+/* Defines -------------------------------------------------------------------*/
+// must fit the values of all parameters of the CloudConnector domain, the
+// biggest one is the server CA certificate
+#define CONFIG_CACHE_BUFFER_SIZE    4096
+
 /* Instance variables --------------------------------------------------------*/
-OS_ConfigServiceHandle_t serverLibWithMemBackend;
+static uint8_t configCacheBuffer[CONFIG_CACHE_BUFFER_SIZE];
 
 OS_Error_t
-init_config_handle(OS_ConfigServiceHandle_t* configHandle)
+init_config_cache(
+    ConfigCache_t* configCache,
+    const char* domainName)
 {
-    static OS_ConfigService_ClientCtx_t ctx =
+    static const if_ConfigServerBulk_t configServer =
+        IF_CONFIGSERVERBULK_ASSIGN(
+            configServerBulk_rpc,
+            configServer_port);
+
+    OS_Error_t err = ConfigCache_init(
+                         configCache,
+                         configCacheBuffer,
+                         sizeof(configCacheBuffer));
+    if (err != OS_SUCCESS)
     {
-        .dataport = OS_DATAPORT_ASSIGN(configServer_port)
-    };
-    OS_Error_t err = OS_ConfigService_createHandleRemote(
-                         &ctx,
-                         configHandle);
+        Debug_LOG_ERROR("ConfigCache_init() failed with :%d", err);
+        return err;
+    }
+
+    err = ConfigCache_fetchDomain(configCache, &configServer, domainName);
     if (err != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("OS_ConfigService_createHandleRemote() failed with :%d", err);
+        Debug_LOG_ERROR("ConfigCache_fetchDomain() failed with :%d", err);
         return err;
     }
 
@@ -0,0 +1,176 @@
+/*
+ * Metrics of the CloudConnector.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "metrics.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+//------------------------------------------------------------------------------
+#define METRICS_KEY(_name_, _key_, ...)         _key_,
+#define METRICS_BOUNDS(_name_, _key_, _bounds_) bounds ## _bounds_,
+
+#define NUM_BOUNDS                              (Metrics_HISTOGRAM_BUCKETS - 1)
+
+static const uint32_t boundsUS[NUM_BOUNDS]      = { Metrics_BOUNDS_US };
+static const uint32_t boundsCOUNT[NUM_BOUNDS]   = { Metrics_BOUNDS_COUNT };
+static const uint32_t boundsBYTES[NUM_BOUNDS]   = { Metrics_BOUNDS_BYTES };
+
+static const char* const counterKeys[]   = { METRICS_COUNTERS(METRICS_KEY) };
+static const char* const gaugeKeys[]     = { METRICS_GAUGES(METRICS_KEY) };
+static const char* const histogramKeys[] = { METRICS_HISTOGRAMS(METRICS_KEY) };
+
+static const uint32_t* const histogramBounds[] =
+{
+    METRICS_HISTOGRAMS(METRICS_BOUNDS)
+};
+
+typedef struct
+{
+    uint32_t    count;
+    uint32_t    sum;
+    uint32_t    buckets[Metrics_HISTOGRAM_BUCKETS];
+} Histogram_t;
+
+static struct
+{
+    uint32_t    counters[METRICS_NUM_COUNTERS];
+    uint32_t    gauges[METRICS_NUM_GAUGES];
+    Histogram_t histograms[METRICS_NUM_HISTOGRAMS];
+} metrics;
+
+//------------------------------------------------------------------------------
+static inline uint32_t
+load(
+    const uint32_t* value)
+{
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+// Append to the object at *pos, sets *ok to false if it does not fit.
+static void
+append(
+    char*       buf,
+    size_t      size,
+    size_t*     pos,
+    bool*       ok,
+    const char* fmt,
+    ...)
+{
+    if (!*ok)
+    {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(buf + *pos, size - *pos, fmt, args);
+    va_end(args);
+
+    if ((len < 0) || ((size_t)len >= (size - *pos)))
+    {
+        *ok = false;
+        return;
+    }
+
+    *pos += len;
+}
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+void
+Metrics_add(
+    Metrics_Counter_t   counter,
+    uint32_t            value)
+{
+    __atomic_fetch_add(&metrics.counters[counter], value, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+Metrics_getCounter(
+    Metrics_Counter_t   counter)
+{
+    return load(&metrics.counters[counter]);
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics_set(
+    Metrics_Gauge_t     gauge,
+    uint32_t            value)
+{
+    __atomic_store_n(&metrics.gauges[gauge], value, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics_observe(
+    Metrics_Histogram_t histogram,
+    uint32_t            value)
+{
+    Histogram_t* h = &metrics.histograms[histogram];
+    const uint32_t* bounds = histogramBounds[histogram];
+
+    size_t bucket = 0;
+    while ((bucket < NUM_BOUNDS) && (value > bounds[bucket]))
+    {
+        bucket++;
+    }
+
+    __atomic_fetch_add(&h->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, value, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+size_t
+Metrics_format(
+    char*               buf,
+    size_t              size)
+{
+    size_t pos = 0;
+    bool ok = (size > 0);
+
+    append(buf, size, &pos, &ok, "{");
+
+    for (size_t i = 0; i < METRICS_NUM_COUNTERS; i++)
+    {
+        append(buf, size, &pos, &ok, "%s\"%s\":%u", (i > 0) ? "," : "",
+               counterKeys[i], load(&metrics.counters[i]));
+    }
+
+    for (size_t i = 0; i < METRICS_NUM_GAUGES; i++)
+    {
+        append(buf, size, &pos, &ok, ",\"%s\":%u", gaugeKeys[i],
+               load(&metrics.gauges[i]));
+    }
+
+    for (size_t i = 0; i < METRICS_NUM_HISTOGRAMS; i++)
+    {
+        const Histogram_t* h = &metrics.histograms[i];
+
+        append(buf, size, &pos, &ok, ",\"%s\":{\"n\":%u,\"sum\":%u,\"b\":[",
+               histogramKeys[i], load(&h->count), load(&h->sum));
+        for (size_t b = 0; b < Metrics_HISTOGRAM_BUCKETS; b++)
+        {
+            append(buf, size, &pos, &ok, "%s%u", (b > 0) ? "," : "",
+                   load(&h->buckets[b]));
+        }
+        append(buf, size, &pos, &ok, "]}");
+    }
+
+    append(buf, size, &pos, &ok, "}");
+
+    return ok ? pos : 0;
+}
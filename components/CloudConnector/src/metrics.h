@@ -0,0 +1,133 @@
+/*
+ * Metrics of the CloudConnector.
+ *
+ * Counters only grow and wrap around at 2^32, so a reader takes the difference
+ * of two readings modulo 2^32. Gauges hold the current value. A histogram
+ * counts its values in the buckets of one of the Metrics_BOUNDS_* and keeps
+ * their number and sum, both wrap around like counters.
+ *
+ * The metrics are updated with atomic operations, so any thread of the
+ * component can update them without holding a lock. Metrics_format() writes
+ * all of them as one compact JSON object, which is what the getMetrics() RPC
+ * returns and what is published to the cloud periodically.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+//   _X_(name, key in the JSON object)
+#define METRICS_COUNTERS(_X_)                                                 \
+    _X_(CONNECTS,           "connects")         /* to the cloud */            \
+    _X_(CONNECT_ERRORS,     "connectErrors")                                  \
+    _X_(RECONNECTS,         "reconnects")       /* by the RPC thread */       \
+    _X_(MESSAGES,           "messages")         /* MQTT packets of sensor */  \
+    _X_(IGNORED,            "ignored")          /* packets not forwarded */   \
+    _X_(PUBLISHES,          "publishes")        /* acknowledged by cloud */   \
+    _X_(PUBLISH_ERRORS,     "publishErrors")                                  \
+    _X_(QUEUE_DROPPED,      "queueDropped")                                   \
+    _X_(BYTES_OUT,          "bytesOut")         /* TLS payload */             \
+    _X_(BYTES_IN,           "bytesIn")          /* TLS payload */             \
+    _X_(WOULD_BLOCK,        "wouldBlock")       /* TLS retries */             \
+    _X_(CORKED_WRITES,      "corkedWrites")     /* packets collected */       \
+    _X_(CORK_FLUSHES,       "corkFlushes")      /* records sent of them */  \
+    _X_(TLS_REUSES,         "tlsReuses")        /* CA not parsed again */
+
+#define METRICS_GAUGES(_X_)                                                   \
+    _X_(QUEUE_DEPTH,        "queueDepth")                                     \
+    _X_(CONNECTED,          "connected")
+
+// A call of glue_tls_mqtt_write() or glue_tls_mqtt_read() sends or receives
+// one part of an MQTT packet. The time it spends in retries after
+// OS_ERROR_WOULD_BLOCK is blocked by the network, the rest is spent in the
+// TLS library, mostly on crypto. The connection phases are timed when they
+// succeed.
+//
+//   _X_(name, key in the JSON object, bounds)
+#define METRICS_HISTOGRAMS(_X_)                                               \
+    _X_(PUBLISH_RTT,        "publishRttUs",         US)                       \
+    _X_(TLS_WRITE,          "tlsWriteUs",           US)                       \
+    _X_(TLS_WRITE_BLOCKED,  "tlsWriteBlockedUs",    US)                       \
+    _X_(TLS_WRITE_CALLS,    "tlsWriteCalls",        COUNT)                    \
+    _X_(TLS_WRITE_SPINS,    "tlsWriteSpins",        COUNT)                    \
+    _X_(TLS_WRITE_BYTES,    "tlsWriteBytes",        BYTES) /* per call */     \
+    _X_(TLS_READ,           "tlsReadUs",            US)                       \
+    _X_(TLS_READ_BLOCKED,   "tlsReadBlockedUs",     US)                       \
+    _X_(TLS_READ_CALLS,     "tlsReadCalls",         COUNT)                    \
+    _X_(TLS_READ_SPINS,     "tlsReadSpins",         COUNT)                    \
+    _X_(TLS_READ_BYTES,     "tlsReadBytes",         BYTES) /* per call */     \
+    _X_(TLS_SETUP,          "tlsSetupUs",           US)                       \
+    _X_(TCP_CONNECT,        "tcpConnectUs",         US)                       \
+    _X_(TLS_HANDSHAKE,      "tlsHandshakeUs",       US)                       \
+    _X_(MQTT_CONNECT,       "mqttConnectUs",        US)
+
+// The upper bounds of the buckets, a last bucket takes all larger values.
+#define Metrics_BOUNDS_US                                                     \
+    100, 1000, 10000, 50000, 100000, 250000, 500000, 1000000, 5000000
+#define Metrics_BOUNDS_COUNT                                                  \
+    0, 1, 2, 4, 8, 16, 64, 256, 1024
+#define Metrics_BOUNDS_BYTES                                                  \
+    16, 64, 128, 256, 512, 1024, 2048, 4096, 16384
+#define Metrics_HISTOGRAM_BUCKETS   10
+
+// Enough for all metrics with values of 10 digits.
+#define Metrics_FORMAT_SIZE         3072
+
+#define METRICS_ENUM(_name_, _key_, ...)    METRICS_ ## _name_,
+
+typedef enum
+{
+    METRICS_COUNTERS(METRICS_ENUM)
+    METRICS_NUM_COUNTERS
+} Metrics_Counter_t;
+
+typedef enum
+{
+    METRICS_GAUGES(METRICS_ENUM)
+    METRICS_NUM_GAUGES
+} Metrics_Gauge_t;
+
+typedef enum
+{
+    METRICS_HISTOGRAMS(METRICS_ENUM)
+    METRICS_NUM_HISTOGRAMS
+} Metrics_Histogram_t;
+
+//------------------------------------------------------------------------------
+void
+Metrics_add(
+    Metrics_Counter_t   counter,
+    uint32_t            value);
+
+//------------------------------------------------------------------------------
+uint32_t
+Metrics_getCounter(
+    Metrics_Counter_t   counter);
+
+//------------------------------------------------------------------------------
+void
+Metrics_set(
+    Metrics_Gauge_t     gauge,
+    uint32_t            value);
+
+//------------------------------------------------------------------------------
+void
+Metrics_observe(
+    Metrics_Histogram_t histogram,
+    uint32_t            value);
+
+//------------------------------------------------------------------------------
+// Write all metrics as a zero terminated JSON object to buf. Returns its
+// length without the zero, or 0 if it does not fit into size bytes.
+size_t
+Metrics_format(
+    char*               buf,
+    size_t              size);
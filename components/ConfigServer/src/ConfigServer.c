@@ -13,9 +13,30 @@
 
 #include "lib_debug/Debug.h"
 #include "init_config_backend.h"
+#include "config_publish.h"
+#include "config_log_levels.h"
+#include "boot_trace.h"
 
-void post_init(void)
+#if defined(CONFIG_INDEX_BENCHMARK)
+#include "config_index_bench.h"
+#endif
+
+static const if_OS_Timer_t timer =
+    IF_OS_TIMER_ASSIGN(
+        timeServer_rpc,
+        timeServer_notify);
+
+static const BootTrace_t bootTrace =
+    BootTrace_ASSIGN(
+        bootTrace_port,
+        &timer,
+        BOOT_TRACE_CONFIGSERVER_SLOT,
+        "ConfigServer");
+
+//------------------------------------------------------------------------------
+static void init_config_server(void)
 {
+    BOOT_TRACE_MARK(&bootTrace, "post_init");
     Debug_LOG_INFO("Starting ConfigServer...");
 
     OS_Error_t err = init_system_config_backend();
@@ -24,8 +45,47 @@ void post_init(void)
         Debug_LOG_ERROR("init_system_config_backend() failed with:%d", err);
         return;
     }
+    BOOT_TRACE_MARK(&bootTrace, "backend_ready");
+
+    OS_ConfigServiceHandle_t hConfig;
+    err = OS_ConfigService_createHandleLocal(&hConfig);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigService_createHandleLocal() failed with:%d",
+                        err);
+        return;
+    }
+
+    err = ConfigPublish_snapshot(hConfig);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("ConfigPublish_snapshot() failed with:%d", err);
+        return;
+    }
+    BOOT_TRACE_MARK(&bootTrace, "snapshot_published");
+
+    // the components log with the levels of their build until then
+    err = ConfigLogLevels_push(hConfig);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_WARNING("ConfigLogLevels_push() failed with:%d", err);
+    }
+
+#if defined(CONFIG_INDEX_BENCHMARK)
+    ConfigIndex_bench_run(hConfig);
+#endif
 
     Debug_LOG_INFO("Config Server initialized.");
 
     return;
 }
+
+//------------------------------------------------------------------------------
+void post_init(void)
+{
+    // the RPCs wait until the backends are set up and the snapshot is
+    // published
+    configMutex_lock();
+    init_config_server();
+    configMutex_unlock();
+}
@@ -0,0 +1,602 @@
+/*
+ * Implementation of the if_ConfigServerBulk interface of the ConfigServer.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <string.h>
+#include <camkes.h>
+
+#include "lib_debug/Debug.h"
+#include "config_bulk.h"
+#include "config_index.h"
+#include "config_snapshot.h"
+#include "config_publish.h"
+#include "config_log_levels.h"
+#include "init_config_backend.h"
+#include "config_params.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define CONFIG_BULK_MAX_REQUEST \
+    (OS_DATAPORT_DEFAULT_SIZE / sizeof(ConfigBulk_Record_t))
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+    seL4_Word       clientId;
+    OS_Dataport_t   dataport;
+} ConfigBulk_Client_t;
+
+// the client id is the badge assigned via the rpc attributes in the assembly
+static const ConfigBulk_Client_t clients[] =
+{
+    {
+        .clientId = CONFIGSERVER_CLIENT_SENSOR_ID,
+        .dataport = OS_DATAPORT_ASSIGN(sensor_port)
+    },
+    {
+        .clientId = CONFIGSERVER_CLIENT_CLOUDCONNECTOR_ID,
+        .dataport = OS_DATAPORT_ASSIGN(cloudConnector_port)
+    },
+    {
+        .clientId = CONFIGSERVER_CLIENT_NWSTACKCONFIG_ID,
+        .dataport = OS_DATAPORT_ASSIGN(nwStackConfigurator_port)
+    },
+#if defined(CONFIGSERVER_ADMIN_CLIENT)
+    {
+        .clientId = CONFIGSERVER_CLIENT_ADMIN_ID,
+        .dataport = OS_DATAPORT_ASSIGN(admin_port)
+    },
+#endif
+};
+
+// The parameters a client may change with setParameter(), all other writes
+// are denied. A client only changes the parameters of its own domain and its
+// own log level, the admin client the log levels of all components. A value
+// may not be larger than the size generated from config.xml, the clients size
+// their buffers by it.
+typedef struct
+{
+    seL4_Word   clientId;
+    const char* domainName;
+    const char* parameterName;
+    size_t      maxSize;
+} ConfigBulk_Writable_t;
+
+static const ConfigBulk_Writable_t writables[] =
+{
+    {
+        CONFIGSERVER_CLIENT_SENSOR_ID,
+        CONFIG_SENSOR_NAME,
+        CONFIG_SENSOR_MQTT_TOPIC_NAME,
+        CONFIG_SENSOR_MQTT_TOPIC_SIZE
+    },
+    {
+        CONFIGSERVER_CLIENT_SENSOR_ID,
+        CONFIG_LOGGING_NAME,
+        CONFIG_LOGGING_SENSOR_NAME,
+        CONFIG_LOGGING_SENSOR_SIZE
+    },
+    {
+        CONFIGSERVER_CLIENT_CLOUDCONNECTOR_ID,
+        CONFIG_CLOUD_CONNECTOR_NAME,
+        CONFIG_CLOUD_CONNECTOR_SERVER_PORT_NAME,
+        CONFIG_CLOUD_CONNECTOR_SERVER_PORT_SIZE
+    },
+    {
+        CONFIGSERVER_CLIENT_CLOUDCONNECTOR_ID,
+        CONFIG_CLOUD_CONNECTOR_NAME,
+        CONFIG_CLOUD_CONNECTOR_METRICS_TOPIC_NAME,
+        CONFIG_CLOUD_CONNECTOR_METRICS_TOPIC_SIZE
+    },
+    {
+        CONFIGSERVER_CLIENT_CLOUDCONNECTOR_ID,
+        CONFIG_CLOUD_CONNECTOR_NAME,
+        CONFIG_CLOUD_CONNECTOR_METRICS_INTERVAL_NAME,
+        CONFIG_CLOUD_CONNECTOR_METRICS_INTERVAL_SIZE
+    },
+#if defined(CONFIGSERVER_CA_CERT_WRITABLE)
+    {
+        CONFIGSERVER_CLIENT_CLOUDCONNECTOR_ID,
+        CONFIG_CLOUD_CONNECTOR_NAME,
+        CONFIG_CLOUD_CONNECTOR_SERVER_CA_CERT_NAME,
+        CONFIG_CLOUD_CONNECTOR_SERVER_CA_CERT_SIZE
+    },
+#endif
+    {
+        CONFIGSERVER_CLIENT_CLOUDCONNECTOR_ID,
+        CONFIG_LOGGING_NAME,
+        CONFIG_LOGGING_CLOUD_CONNECTOR_NAME,
+        CONFIG_LOGGING_CLOUD_CONNECTOR_SIZE
+    },
+#if defined(CONFIGSERVER_ADMIN_CLIENT)
+    {
+        CONFIGSERVER_CLIENT_ADMIN_ID,
+        CONFIG_LOGGING_NAME,
+        CONFIG_LOGGING_CONFIG_SERVER_NAME,
+        CONFIG_LOGGING_CONFIG_SERVER_SIZE
+    },
+    {
+        CONFIGSERVER_CLIENT_ADMIN_ID,
+        CONFIG_LOGGING_NAME,
+        CONFIG_LOGGING_CLOUD_CONNECTOR_NAME,
+        CONFIG_LOGGING_CLOUD_CONNECTOR_SIZE
+    },
+    {
+        CONFIGSERVER_CLIENT_ADMIN_ID,
+        CONFIG_LOGGING_NAME,
+        CONFIG_LOGGING_SENSOR_NAME,
+        CONFIG_LOGGING_SENSOR_SIZE
+    },
+    {
+        CONFIGSERVER_CLIENT_ADMIN_ID,
+        CONFIG_LOGGING_NAME,
+        CONFIG_LOGGING_NIC_NAME,
+        CONFIG_LOGGING_NIC_SIZE
+    },
+    {
+        CONFIGSERVER_CLIENT_ADMIN_ID,
+        CONFIG_LOGGING_NAME,
+        CONFIG_LOGGING_NW_STACK_NAME,
+        CONFIG_LOGGING_NW_STACK_SIZE
+    },
+#endif
+};
+
+static OS_ConfigServiceHandle_t hConfig;
+static bool isHandleCreated = false;
+
+// the response of getParameters() overwrites the request in the dataport
+static ConfigBulk_Record_t requestCopy[CONFIG_BULK_MAX_REQUEST];
+
+// Private functions -----------------------------------------------------------
+
+//------------------------------------------------------------------------------
+static
+const OS_Dataport_t*
+getClientDataport(void)
+{
+    seL4_Word clientId = configServerBulk_rpc_get_sender_id();
+
+    for (size_t i = 0; i < (sizeof(clients) / sizeof(clients[0])); i++)
+    {
+        if (clients[i].clientId == clientId)
+        {
+            return &clients[i].dataport;
+        }
+    }
+
+    Debug_LOG_ERROR("Unknown client id %u", (unsigned int)clientId);
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+static
+const ConfigBulk_Writable_t*
+findWritable(
+    const char* domainName,
+    const char* parameterName)
+{
+    seL4_Word clientId = configServerBulk_rpc_get_sender_id();
+
+    for (size_t i = 0; i < (sizeof(writables) / sizeof(writables[0])); i++)
+    {
+        const ConfigBulk_Writable_t* writable = &writables[i];
+        if ((writable->clientId == clientId)
+            && (0 == strncmp(writable->domainName,
+                             domainName,
+                             OS_CONFIG_LIB_DOMAIN_NAME_SIZE))
+            && (0 == strncmp(writable->parameterName,
+                             parameterName,
+                             OS_CONFIG_LIB_PARAMETER_NAME_SIZE)))
+        {
+            return writable;
+        }
+    }
+
+    Debug_LOG_WARNING("Client %u must not write parameter %s of %s",
+                      (unsigned int)clientId, parameterName, domainName);
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+getConfigHandle(
+    OS_ConfigServiceHandle_t* handle)
+{
+    if (!isHandleCreated)
+    {
+        OS_Error_t err = OS_ConfigService_createHandleLocal(&hConfig);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("OS_ConfigService_createHandleLocal() failed with: %d",
+                            err);
+            return err;
+        }
+        isHandleCreated = true;
+    }
+
+    *handle = hConfig;
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+const ConfigIndex_Domain_t*
+findDomain(
+    const char* domainName)
+{
+    const ConfigIndex_Domain_t* domain =
+        ConfigIndex_findDomain(ConfigIndex_getInstance(), domainName);
+    if (NULL == domain)
+    {
+        Debug_LOG_DEBUG("Domain %s not found", domainName);
+    }
+
+    return domain;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+packParameter(
+    OS_ConfigServiceHandle_t handle,
+    const OS_ConfigServiceLibTypes_Parameter_t* parameter,
+    uint8_t* buf,
+    size_t bufSize,
+    size_t* packedSize)
+{
+    OS_ConfigServiceLibTypes_ParameterName_t name;
+    OS_ConfigServiceLibTypes_ParameterType_t type;
+
+    size_t valueSize = OS_ConfigService_parameterGetSize(parameter);
+    size_t recordSize = ConfigBulk_RECORD_SIZE(valueSize);
+    if (recordSize > bufSize)
+    {
+        return OS_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    OS_ConfigService_parameterGetName(parameter, &name);
+    OS_ConfigService_parameterGetType(parameter, &type);
+
+    ConfigBulk_Record_t* record = (ConfigBulk_Record_t*)buf;
+    memset(record, 0, recordSize);
+    memcpy(record->name, name.name, sizeof(record->name));
+    record->status = OS_SUCCESS;
+    record->type = type;
+    record->size = valueSize;
+
+    size_t bytesCopied;
+    OS_Error_t err = OS_ConfigService_parameterGetValue(
+                         handle,
+                         parameter,
+                         &buf[sizeof(*record)],
+                         valueSize,
+                         &bytesCopied);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigService_parameterGetValue() for %s failed with: %d",
+                        name.name, err);
+        return err;
+    }
+
+    *packedSize = recordSize;
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+getDomain(
+    const char*     domainName,
+    unsigned int    firstParameter,
+    unsigned int*   numParameters,
+    unsigned int*   numRemaining)
+{
+    *numParameters = 0;
+    *numRemaining = 0;
+
+    const OS_Dataport_t* port = getClientDataport();
+    if (NULL == port)
+    {
+        return OS_ERROR_ACCESS_DENIED;
+    }
+
+    OS_ConfigServiceHandle_t handle;
+    OS_Error_t err = getConfigHandle(&handle);
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    const ConfigIndex_Domain_t* domain = findDomain(domainName);
+    if (NULL == domain)
+    {
+        return OS_ERROR_CONFIG_DOMAIN_NOT_FOUND;
+    }
+
+    const ConfigIndex_t* index = ConfigIndex_getInstance();
+    uint8_t* buf = OS_Dataport_getBuf(*port);
+    size_t bufSize = OS_Dataport_getSize(*port);
+    size_t used = 0;
+
+    for (size_t idx = firstParameter; idx < domain->numParameters; idx++)
+    {
+        const ConfigIndex_Parameter_t* entry =
+            &index->parameters[domain->firstParameter + idx];
+
+        size_t packedSize;
+        err = packParameter(
+                  handle,
+                  &entry->parameter,
+                  &buf[used],
+                  bufSize - used,
+                  &packedSize);
+        if (err == OS_ERROR_BUFFER_TOO_SMALL)
+        {
+            if (0 == *numParameters)
+            {
+                Debug_LOG_ERROR("Parameter %zu of %s exceeds the dataport",
+                                idx, domainName);
+                return err;
+            }
+            *numRemaining = domain->numParameters - idx;
+            break;
+        }
+        else if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+
+        used += packedSize;
+        (*numParameters)++;
+    }
+
+    Debug_LOG_DEBUG("Packed %u parameters of %s, %u remaining",
+                    *numParameters, domainName, *numRemaining);
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+getParameters(
+    const char*     domainName,
+    unsigned int    numParameters)
+{
+    const OS_Dataport_t* port = getClientDataport();
+    if (NULL == port)
+    {
+        return OS_ERROR_ACCESS_DENIED;
+    }
+
+    uint8_t* buf = OS_Dataport_getBuf(*port);
+    size_t bufSize = OS_Dataport_getSize(*port);
+
+    if ((numParameters > CONFIG_BULK_MAX_REQUEST)
+        || ((numParameters * sizeof(ConfigBulk_Record_t)) > bufSize))
+    {
+        Debug_LOG_ERROR("Too many parameters in request: %u", numParameters);
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    memcpy(requestCopy, buf, numParameters * sizeof(ConfigBulk_Record_t));
+
+    OS_ConfigServiceHandle_t handle;
+    OS_Error_t err = getConfigHandle(&handle);
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    const ConfigIndex_Domain_t* domain = findDomain(domainName);
+    if (NULL == domain)
+    {
+        return OS_ERROR_CONFIG_DOMAIN_NOT_FOUND;
+    }
+
+    const ConfigIndex_t* index = ConfigIndex_getInstance();
+    size_t used = 0;
+    for (unsigned int i = 0; i < numParameters; i++)
+    {
+        OS_ConfigServiceLibTypes_ParameterName_t name;
+        memcpy(name.name, requestCopy[i].name, sizeof(name.name));
+        name.name[sizeof(name.name) - 1] = '\0';
+
+        // keep space for the records of all following parameters
+        size_t available = bufSize - used
+                           - ((numParameters - i - 1) * sizeof(ConfigBulk_Record_t));
+
+        const ConfigIndex_Parameter_t* entry =
+            ConfigIndex_findParameter(index, domain, name.name);
+        if (NULL == entry)
+        {
+            Debug_LOG_DEBUG("Parameter %s not found in %s", name.name, domainName);
+            err = OS_ERROR_CONFIG_PARAMETER_NOT_FOUND;
+        }
+        else
+        {
+            size_t packedSize;
+            err = packParameter(
+                      handle,
+                      &entry->parameter,
+                      &buf[used],
+                      available,
+                      &packedSize);
+            if (err == OS_SUCCESS)
+            {
+                used += packedSize;
+                continue;
+            }
+        }
+
+        // a failed parameter gets a record with the status only
+        ConfigBulk_Record_t* record = (ConfigBulk_Record_t*)&buf[used];
+        memset(record, 0, sizeof(*record));
+        memcpy(record->name, name.name, sizeof(record->name));
+        record->status = err;
+        used += sizeof(*record);
+    }
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+setParameter(
+    const char*     domainName,
+    const char*     parameterName,
+    unsigned int    valueSize)
+{
+    const OS_Dataport_t* port = getClientDataport();
+    if (NULL == port)
+    {
+        return OS_ERROR_ACCESS_DENIED;
+    }
+
+    const ConfigBulk_Writable_t* writable =
+        findWritable(domainName, parameterName);
+    if (NULL == writable)
+    {
+        return OS_ERROR_ACCESS_DENIED;
+    }
+
+    if (valueSize > writable->maxSize)
+    {
+        Debug_LOG_ERROR("Value of %s has %u bytes, max is %zu",
+                        parameterName, valueSize, writable->maxSize);
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (valueSize > OS_Dataport_getSize(*port))
+    {
+        Debug_LOG_ERROR("Value size %u exceeds the dataport", valueSize);
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    OS_ConfigServiceHandle_t handle;
+    OS_Error_t err = getConfigHandle(&handle);
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    const ConfigIndex_Domain_t* domain = findDomain(domainName);
+    if (NULL == domain)
+    {
+        return OS_ERROR_CONFIG_DOMAIN_NOT_FOUND;
+    }
+
+    err = ConfigIndex_setParameter(
+              ConfigIndex_getInstance(),
+              handle,
+              domain,
+              parameterName,
+              OS_Dataport_getBuf(*port),
+              valueSize);
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    err = sync_system_config_backend();
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("sync_system_config_backend() failed with: %d", err);
+        return err;
+    }
+
+    err = ConfigPublish_snapshot(handle);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("ConfigPublish_snapshot() failed with: %d", err);
+        return err;
+    }
+
+    // a changed log level takes effect at once, not only after a reboot
+    if (ConfigLogLevels_isDomain(domainName))
+    {
+        err = ConfigLogLevels_push(handle);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("ConfigLogLevels_push() failed with: %d", err);
+            return err;
+        }
+    }
+
+    Debug_LOG_INFO("Parameter %s of %s changed, domain version %u",
+                   parameterName, domainName, domain->version);
+
+    return OS_SUCCESS;
+}
+
+// Public functions ------------------------------------------------------------
+
+// Every RPC holds configMutex, so the calls of the clients are serialized with
+// each other and with post_init(). The config library, the index and the
+// snapshot are not thread safe.
+
+//------------------------------------------------------------------------------
+OS_Error_t
+configServerBulk_rpc_getDomain(
+    const char*     domainName,
+    unsigned int    firstParameter,
+    unsigned int*   numParameters,
+    unsigned int*   numRemaining)
+{
+    configMutex_lock();
+    OS_Error_t err = getDomain(domainName, firstParameter, numParameters,
+                               numRemaining);
+    configMutex_unlock();
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+configServerBulk_rpc_getParameters(
+    const char*     domainName,
+    unsigned int    numParameters)
+{
+    configMutex_lock();
+    OS_Error_t err = getParameters(domainName, numParameters);
+    configMutex_unlock();
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+configServerBulk_rpc_setParameter(
+    const char*     domainName,
+    const char*     parameterName,
+    unsigned int    valueSize)
+{
+    configMutex_lock();
+    OS_Error_t err = setParameter(domainName, parameterName, valueSize);
+    configMutex_unlock();
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+configServerBulk_rpc_getSnapshotVersion(
+    unsigned int* version)
+{
+    static const ConfigSnapshot_t snapshot =
+        ConfigSnapshot_ASSIGN(configSnapshot_port, CONFIG_SNAPSHOT_SIZE);
+
+    configMutex_lock();
+    *version = ConfigSnapshot_getVersion(&snapshot);
+    configMutex_unlock();
+
+    return OS_SUCCESS;
+}
@@ -0,0 +1,154 @@
+/*
+ * Single file image of the ConfigServer tables.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "lib_debug/Debug.h"
+
+#include "config_image.h"
+
+/* Instance variables --------------------------------------------------------*/
+// CRC-32 of every nibble with the polynomial 0xEDB88320. The CRC is computed
+// on start-up and after every write of the image, the table of nibbles takes
+// two lookups per byte but only 64 bytes instead of the 1 KiB of a byte table.
+static const uint32_t crc32Nibbles[16] =
+{
+    0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+    0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+    0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+    0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU,
+};
+
+// Private functions -----------------------------------------------------------
+
+//------------------------------------------------------------------------------
+static
+const ConfigImage_Section_t*
+getSections(
+    const void* image)
+{
+    const ConfigImage_Header_t* header = image;
+
+    return (const ConfigImage_Section_t*)
+           ((const uint8_t*)image + header->headerSize);
+}
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+uint32_t
+ConfigImage_crc32(
+    const void* data,
+    size_t      size)
+{
+    const uint8_t* bytes = data;
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ crc32Nibbles[crc & 0x0FU];
+        crc = (crc >> 4) ^ crc32Nibbles[crc & 0x0FU];
+    }
+
+    return ~crc;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigImage_validate(
+    const void* image,
+    size_t      size)
+{
+    const ConfigImage_Header_t* header = image;
+
+    if ((size < sizeof(*header))
+        || (header->magic != ConfigImage_MAGIC))
+    {
+        Debug_LOG_ERROR("Config image has no valid header");
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (header->formatVersion != ConfigImage_FORMAT_VERSION)
+    {
+        Debug_LOG_ERROR("Config image format %u is not supported",
+                        header->formatVersion);
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+
+    if ((header->imageSize != size)
+        || (header->headerSize < sizeof(*header))
+        || (header->headerSize > size)
+        || (header->numSections != ConfigImage_NUM_SECTIONS)
+        || ((header->numSections * sizeof(ConfigImage_Section_t))
+            > (size - header->headerSize)))
+    {
+        Debug_LOG_ERROR("Config image of %zu bytes has an invalid layout", size);
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    uint32_t crc = ConfigImage_crc32(
+                       (const uint8_t*)image + ConfigImage_CRC_OFFSET,
+                       size - ConfigImage_CRC_OFFSET);
+    if (crc != header->crc)
+    {
+        Debug_LOG_ERROR("Config image CRC is 0x%08x, expected 0x%08x",
+                        crc, header->crc);
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    const ConfigImage_Section_t* sections = getSections(image);
+    for (size_t i = 0; i < header->numSections; i++)
+    {
+        const ConfigImage_Section_t* section = &sections[i];
+        uint64_t sectionSize = (uint64_t)section->numRecords
+                               * section->sizeOfRecord;
+
+        if ((section->type != (i + ConfigImage_SECTION_PARAMETER))
+            || (section->offset % ConfigImage_SECTION_ALIGN)
+            || (section->offset > size)
+            || (sectionSize > (size - section->offset)))
+        {
+            Debug_LOG_ERROR("Config image section %zu is invalid", i);
+            return OS_ERROR_INVALID_PARAMETER;
+        }
+    }
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+const ConfigImage_Section_t*
+ConfigImage_getSection(
+    const void*                 image,
+    ConfigImage_SectionType_t   type)
+{
+    // the sections are stored in the order of their types
+    return &getSections(image)[type - ConfigImage_SECTION_PARAMETER];
+}
+
+//------------------------------------------------------------------------------
+void*
+ConfigImage_getRecords(
+    void*                           image,
+    const ConfigImage_Section_t*    section)
+{
+    return (uint8_t*)image + section->offset;
+}
+
+//------------------------------------------------------------------------------
+void
+ConfigImage_updateCrc(
+    void* image)
+{
+    ConfigImage_Header_t* header = image;
+
+    header->crc = ConfigImage_crc32(
+                      (const uint8_t*)image + ConfigImage_CRC_OFFSET,
+                      header->imageSize - ConfigImage_CRC_OFFSET);
+}
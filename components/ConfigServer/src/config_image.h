@@ -0,0 +1,113 @@
+/*
+ * Single file image of the ConfigServer tables.
+ *
+ * The config library keeps its parameters, domains, strings and blobs in four
+ * tables of fixed size records. The image holds all four tables in one file,
+ * so the ConfigServer loads the whole configuration with one sequential read
+ * and checks it once against the CRC in the header. The image is built on the
+ * host by tools/config_image.py from the output of the config provisioning
+ * tool, the format is described there as well.
+ *
+ * All fields are 32-bit little endian values. A header is followed by the
+ * section table and the sections, which start at a multiple of
+ * ConfigImage_SECTION_ALIGN. The CRC covers everything after its own field,
+ * so the number of sections and the generation are protected as well. The
+ * ConfigServer keeps two copies of the image and loads the valid one with the
+ * higher generation, see init_config_backend.c.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "OS_Error.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define ConfigImage_MAGIC           0x474d4943  // "CIMG"
+#define ConfigImage_FORMAT_VERSION  2
+
+#define ConfigImage_SECTION_ALIGN   64
+
+/* Public types --------------------------------------------------------------*/
+typedef enum
+{
+    ConfigImage_SECTION_PARAMETER = 1,
+    ConfigImage_SECTION_DOMAIN,
+    ConfigImage_SECTION_STRING,
+    ConfigImage_SECTION_BLOB,
+} ConfigImage_SectionType_t;
+
+#define ConfigImage_NUM_SECTIONS    4
+
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    formatVersion;
+    uint32_t    headerSize;
+    uint32_t    imageSize;
+    uint32_t    crc;            // CRC-32 from numSections to the end
+    uint32_t    numSections;
+    uint32_t    generation;     // incremented with every write of the image
+} ConfigImage_Header_t;
+
+// Start of the bytes covered by the CRC.
+#define ConfigImage_CRC_OFFSET      offsetof(ConfigImage_Header_t, numSections)
+
+typedef struct
+{
+    uint32_t    type;           // ConfigImage_SectionType_t
+    uint32_t    numRecords;
+    uint32_t    sizeOfRecord;
+    uint32_t    offset;         // from the start of the image
+} ConfigImage_Section_t;
+
+/* Public functions ----------------------------------------------------------*/
+
+// CRC-32 as used by zlib, so the host tool can compute it with zlib.crc32().
+uint32_t
+ConfigImage_crc32(
+    const void* data,
+    size_t      size);
+
+// Check the header, the CRC and that every section lies within the image.
+// This is done once after the image has been loaded.
+OS_Error_t
+ConfigImage_validate(
+    const void* image,
+    size_t      size);
+
+// Get a section of an image that has been validated.
+const ConfigImage_Section_t*
+ConfigImage_getSection(
+    const void*                 image,
+    ConfigImage_SectionType_t   type);
+
+// Get the records of a section of an image that has been validated.
+void*
+ConfigImage_getRecords(
+    void*                           image,
+    const ConfigImage_Section_t*    section);
+
+// Returns true if generation a was written after generation b. The counter
+// may wrap around.
+static inline bool
+ConfigImage_isNewer(
+    uint32_t a,
+    uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+// Update the CRC in the header after records or the generation have been
+// changed.
+void
+ConfigImage_updateCrc(
+    void* image);
@@ -0,0 +1,411 @@
+/*
+ * Hash index over the domain and parameter names of the ConfigServer.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <string.h>
+
+#include "lib_debug/Debug.h"
+#include "config_index.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define FNV_OFFSET_BASIS    2166136261U
+#define FNV_PRIME           16777619U
+
+/* Private variables ---------------------------------------------------------*/
+static ConfigIndex_t configIndex;
+
+// Private functions -----------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// FNV-1a hash of a name, limited to the given maximum length
+static
+uint32_t
+hashName(
+    uint32_t hash,
+    const char* name,
+    size_t maxLen)
+{
+    for (size_t i = 0; (i < maxLen) && (name[i] != '\0'); i++)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+// The same parameter name is used in several domains, so the domain is part
+// of the hash of a parameter.
+static
+uint32_t
+hashParameter(
+    size_t domainIdx,
+    const char* name)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+
+    hash ^= (uint8_t)domainIdx;
+    hash *= FNV_PRIME;
+
+    return hashName(hash, name, OS_CONFIG_LIB_PARAMETER_NAME_SIZE);
+}
+
+//------------------------------------------------------------------------------
+static
+void
+insertSlot(
+    uint16_t* slots,
+    size_t numSlots,
+    uint32_t hash,
+    size_t entryIdx)
+{
+    size_t slot = hash & (numSlots - 1);
+
+    // there are always more slots than entries, so a free slot is found
+    while (slots[slot] != 0)
+    {
+        slot = (slot + 1) & (numSlots - 1);
+    }
+
+    slots[slot] = (uint16_t)(entryIdx + 1);
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of parameters if the parameter is not found.
+static
+size_t
+findParameterIdx(
+    const ConfigIndex_t* self,
+    size_t domainIdx,
+    const char* parameterName)
+{
+    uint32_t hash = hashParameter(domainIdx, parameterName);
+
+    for (size_t slot = hash & (CONFIG_INDEX_PARAMETER_SLOTS - 1);
+         self->parameterSlots[slot] != 0;
+         slot = (slot + 1) & (CONFIG_INDEX_PARAMETER_SLOTS - 1))
+    {
+        size_t idx = self->parameterSlots[slot] - 1;
+        const ConfigIndex_Parameter_t* entry = &self->parameters[idx];
+        if ((entry->hash == hash)
+            && (entry->domainIdx == domainIdx)
+            && (0 == strncmp(entry->name,
+                             parameterName,
+                             OS_CONFIG_LIB_PARAMETER_NAME_SIZE)))
+        {
+            return idx;
+        }
+    }
+
+    return self->numParameters;
+}
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+ConfigIndex_t*
+ConfigIndex_getInstance(void)
+{
+    return &configIndex;
+}
+
+//------------------------------------------------------------------------------
+void
+ConfigIndex_init(
+    ConfigIndex_t* self)
+{
+    memset(self, 0, sizeof(*self));
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigIndex_addDomain(
+    ConfigIndex_t*                                      self,
+    const char*                                         name,
+    const OS_ConfigServiceLibTypes_Domain_t*            domain,
+    const OS_ConfigServiceLibTypes_DomainEnumerator_t*  enumerator)
+{
+    if (self->numDomains >= CONFIG_INDEX_MAX_DOMAINS)
+    {
+        Debug_LOG_ERROR("Too many domains, max is %d", CONFIG_INDEX_MAX_DOMAINS);
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    size_t idx = self->numDomains;
+    ConfigIndex_Domain_t* entry = &self->domains[idx];
+
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->hash           = hashName(FNV_OFFSET_BASIS,
+                                     entry->name,
+                                     sizeof(entry->name));
+    entry->domain         = *domain;
+    entry->enumerator     = *enumerator;
+    entry->firstParameter = self->numParameters;
+    entry->numParameters  = 0;
+    entry->version        = 1;
+
+    insertSlot(self->domainSlots,
+               CONFIG_INDEX_DOMAIN_SLOTS,
+               entry->hash,
+               idx);
+    self->numDomains++;
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigIndex_addParameter(
+    ConfigIndex_t*                                          self,
+    const char*                                             name,
+    const OS_ConfigServiceLibTypes_Parameter_t*             parameter,
+    const OS_ConfigServiceLibTypes_ParameterEnumerator_t*   enumerator)
+{
+    if (0 == self->numDomains)
+    {
+        Debug_LOG_ERROR("No domain for parameter %s", name);
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    if (self->numParameters >= CONFIG_INDEX_MAX_PARAMETERS)
+    {
+        Debug_LOG_ERROR("Too many parameters, max is %d",
+                        CONFIG_INDEX_MAX_PARAMETERS);
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    size_t domainIdx = self->numDomains - 1;
+    size_t idx = self->numParameters;
+    ConfigIndex_Parameter_t* entry = &self->parameters[idx];
+
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->hash       = hashParameter(domainIdx, entry->name);
+    entry->domainIdx  = domainIdx;
+    entry->parameter  = *parameter;
+    entry->enumerator = *enumerator;
+
+    insertSlot(self->parameterSlots,
+               CONFIG_INDEX_PARAMETER_SLOTS,
+               entry->hash,
+               idx);
+    self->domains[domainIdx].numParameters++;
+    self->numParameters++;
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigIndex_build(
+    ConfigIndex_t*              self,
+    OS_ConfigServiceHandle_t    handle)
+{
+    OS_ConfigServiceLibTypes_DomainEnumerator_t domainEnumerator = {0};
+    OS_ConfigServiceLibTypes_Domain_t domain;
+    OS_ConfigServiceLibTypes_DomainName_t domainName;
+
+    ConfigIndex_init(self);
+
+    OS_Error_t err = OS_ConfigService_domainEnumeratorInit(
+                         handle,
+                         &domainEnumerator);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigService_domainEnumeratorInit() failed with: %d",
+                        err);
+        return err;
+    }
+
+    for (;;)
+    {
+        err = OS_ConfigService_domainEnumeratorGetElement(
+                  handle,
+                  &domainEnumerator,
+                  &domain);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("OS_ConfigService_domainEnumeratorGetElement() failed with: %d",
+                            err);
+            return err;
+        }
+
+        OS_ConfigService_domainGetName(&domain, &domainName);
+        err = ConfigIndex_addDomain(
+                  self,
+                  domainName.name,
+                  &domain,
+                  &domainEnumerator);
+        if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+
+        OS_ConfigServiceLibTypes_ParameterEnumerator_t parameterEnumerator = {0};
+        err = OS_ConfigService_parameterEnumeratorInit(
+                  handle,
+                  &domainEnumerator,
+                  &parameterEnumerator);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("OS_ConfigService_parameterEnumeratorInit() failed with: %d",
+                            err);
+            return err;
+        }
+
+        for (;;)
+        {
+            OS_ConfigServiceLibTypes_Parameter_t parameter;
+            OS_ConfigServiceLibTypes_ParameterName_t parameterName;
+
+            err = OS_ConfigService_parameterEnumeratorGetElement(
+                      handle,
+                      &parameterEnumerator,
+                      &parameter);
+            if (err != OS_SUCCESS)
+            {
+                Debug_LOG_ERROR("OS_ConfigService_parameterEnumeratorGetElement() failed with: %d",
+                                err);
+                return err;
+            }
+
+            OS_ConfigService_parameterGetName(&parameter, &parameterName);
+            err = ConfigIndex_addParameter(
+                      self,
+                      parameterName.name,
+                      &parameter,
+                      &parameterEnumerator);
+            if (err != OS_SUCCESS)
+            {
+                return err;
+            }
+
+            // running past the last parameter is reported as an error
+            if (OS_ConfigService_parameterEnumeratorIncrement(
+                    handle,
+                    &parameterEnumerator) != OS_SUCCESS)
+            {
+                break;
+            }
+        }
+
+        // running past the last domain is reported as an error
+        if (OS_ConfigService_domainEnumeratorIncrement(
+                handle,
+                &domainEnumerator) != OS_SUCCESS)
+        {
+            break;
+        }
+    }
+
+    Debug_LOG_INFO("Indexed %zu domains with %zu parameters",
+                   self->numDomains, self->numParameters);
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+const ConfigIndex_Domain_t*
+ConfigIndex_findDomain(
+    const ConfigIndex_t*    self,
+    const char*             domainName)
+{
+    uint32_t hash = hashName(FNV_OFFSET_BASIS,
+                             domainName,
+                             OS_CONFIG_LIB_DOMAIN_NAME_SIZE);
+
+    for (size_t slot = hash & (CONFIG_INDEX_DOMAIN_SLOTS - 1);
+         self->domainSlots[slot] != 0;
+         slot = (slot + 1) & (CONFIG_INDEX_DOMAIN_SLOTS - 1))
+    {
+        const ConfigIndex_Domain_t* entry =
+            &self->domains[self->domainSlots[slot] - 1];
+        if ((entry->hash == hash)
+            && (0 == strncmp(entry->name,
+                             domainName,
+                             OS_CONFIG_LIB_DOMAIN_NAME_SIZE)))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+const ConfigIndex_Parameter_t*
+ConfigIndex_findParameter(
+    const ConfigIndex_t*        self,
+    const ConfigIndex_Domain_t* domain,
+    const char*                 parameterName)
+{
+    size_t idx = findParameterIdx(self, domain - self->domains, parameterName);
+    if (idx >= self->numParameters)
+    {
+        return NULL;
+    }
+
+    return &self->parameters[idx];
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigIndex_setParameter(
+    ConfigIndex_t*              self,
+    OS_ConfigServiceHandle_t    handle,
+    const ConfigIndex_Domain_t* domain,
+    const char*                 parameterName,
+    const void*                 value,
+    size_t                      valueSize)
+{
+    size_t domainIdx = domain - self->domains;
+    size_t idx = findParameterIdx(self, domainIdx, parameterName);
+    if (idx >= self->numParameters)
+    {
+        Debug_LOG_DEBUG("Parameter %s not found in %s",
+                        parameterName, domain->name);
+        return OS_ERROR_CONFIG_PARAMETER_NOT_FOUND;
+    }
+
+    ConfigIndex_Parameter_t* entry = &self->parameters[idx];
+
+    OS_ConfigServiceLibTypes_ParameterType_t type;
+    OS_ConfigService_parameterGetType(&entry->parameter, &type);
+
+    OS_Error_t err = OS_ConfigService_parameterSetValue(
+                         handle,
+                         &entry->enumerator,
+                         type,
+                         value,
+                         valueSize);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigService_parameterSetValue() for %s failed with: %d",
+                        entry->name, err);
+        return err;
+    }
+
+    // the parameter holds the value of integers and the size of the others
+    err = OS_ConfigService_parameterEnumeratorGetElement(
+              handle,
+              &entry->enumerator,
+              &entry->parameter);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigService_parameterEnumeratorGetElement() failed with: %d",
+                        err);
+        return err;
+    }
+
+    self->domains[domainIdx].version++;
+
+    return OS_SUCCESS;
+}
@@ -0,0 +1,124 @@
+/*
+ * Hash index over the domain and parameter names of the ConfigServer.
+ *
+ * The config library finds a domain by walking all domains with an enumerator
+ * and a parameter by scanning the parameter backend. The index is built once
+ * when the backends are initialized and answers name lookups with a single
+ * hash probe, independent of the number of parameters in the image.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "OS_ConfigService.h"
+
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#if !defined(CONFIG_INDEX_MAX_DOMAINS)
+#define CONFIG_INDEX_MAX_DOMAINS        16
+#endif
+
+#if !defined(CONFIG_INDEX_MAX_PARAMETERS)
+#define CONFIG_INDEX_MAX_PARAMETERS     512
+#endif
+
+// The number of slots must be a power of two. Twice the number of entries
+// keeps the probe sequences short.
+#define CONFIG_INDEX_DOMAIN_SLOTS       (2 * CONFIG_INDEX_MAX_DOMAINS)
+#define CONFIG_INDEX_PARAMETER_SLOTS    (2 * CONFIG_INDEX_MAX_PARAMETERS)
+
+/* Public types --------------------------------------------------------------*/
+typedef struct
+{
+    char                                        name[OS_CONFIG_LIB_DOMAIN_NAME_SIZE];
+    uint32_t                                    hash;
+    OS_ConfigServiceLibTypes_Domain_t           domain;
+    OS_ConfigServiceLibTypes_DomainEnumerator_t enumerator;
+    size_t                                      firstParameter;
+    size_t                                      numParameters;
+    uint32_t                                    version;    // changes on every write
+} ConfigIndex_Domain_t;
+
+typedef struct
+{
+    char                                            name[OS_CONFIG_LIB_PARAMETER_NAME_SIZE];
+    uint32_t                                        hash;
+    size_t                                          domainIdx;
+    OS_ConfigServiceLibTypes_Parameter_t            parameter;
+    OS_ConfigServiceLibTypes_ParameterEnumerator_t  enumerator;
+} ConfigIndex_Parameter_t;
+
+// The parameters of a domain are stored one after the other, so the
+// parameters of a domain are parameters[firstParameter] and following.
+typedef struct
+{
+    ConfigIndex_Domain_t    domains[CONFIG_INDEX_MAX_DOMAINS];
+    size_t                  numDomains;
+    ConfigIndex_Parameter_t parameters[CONFIG_INDEX_MAX_PARAMETERS];
+    size_t                  numParameters;
+
+    // slots hold the entry index + 1, zero marks an empty slot
+    uint16_t                domainSlots[CONFIG_INDEX_DOMAIN_SLOTS];
+    uint16_t                parameterSlots[CONFIG_INDEX_PARAMETER_SLOTS];
+} ConfigIndex_t;
+
+/* Public functions ----------------------------------------------------------*/
+
+// The index used by the ConfigServer.
+ConfigIndex_t*
+ConfigIndex_getInstance(void);
+
+void
+ConfigIndex_init(
+    ConfigIndex_t* self);
+
+// Add a domain, the parameters added afterwards belong to this domain.
+OS_Error_t
+ConfigIndex_addDomain(
+    ConfigIndex_t*                                      self,
+    const char*                                         name,
+    const OS_ConfigServiceLibTypes_Domain_t*            domain,
+    const OS_ConfigServiceLibTypes_DomainEnumerator_t*  enumerator);
+
+// Add a parameter to the domain that was added last.
+OS_Error_t
+ConfigIndex_addParameter(
+    ConfigIndex_t*                                          self,
+    const char*                                             name,
+    const OS_ConfigServiceLibTypes_Parameter_t*             parameter,
+    const OS_ConfigServiceLibTypes_ParameterEnumerator_t*   enumerator);
+
+// Walk all domains and parameters of the config library and index them.
+OS_Error_t
+ConfigIndex_build(
+    ConfigIndex_t*              self,
+    OS_ConfigServiceHandle_t    handle);
+
+const ConfigIndex_Domain_t*
+ConfigIndex_findDomain(
+    const ConfigIndex_t*    self,
+    const char*             domainName);
+
+const ConfigIndex_Parameter_t*
+ConfigIndex_findParameter(
+    const ConfigIndex_t*        self,
+    const ConfigIndex_Domain_t* domain,
+    const char*                 parameterName);
+
+// Write the value of a parameter to the config library, update the indexed
+// parameter and increment the version of its domain. The config library
+// enforces the write access of the parameter.
+OS_Error_t
+ConfigIndex_setParameter(
+    ConfigIndex_t*              self,
+    OS_ConfigServiceHandle_t    handle,
+    const ConfigIndex_Domain_t* domain,
+    const char*                 parameterName,
+    const void*                 value,
+    size_t                      valueSize);
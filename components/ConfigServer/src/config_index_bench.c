@@ -0,0 +1,275 @@
+/*
+ * ConfigServer lookup benchmarks
+ *
+ * Measures the time to find a parameter by its name with the hash index and
+ * compares it with a linear scan over the same parameters, which is how the
+ * config library looks up a parameter in its backend. The synthetic cases
+ * show how both scale with the number of parameters, the backend cases
+ * measure the lookups for the parameters of the image that is loaded.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "config_index_bench.h"
+#include "config_index.h"
+
+#include "lib_debug/Debug.h"
+#include "lib_debug/Debug_OS_Error.h"
+#include "TimeServer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <camkes.h>
+
+/* Defines -------------------------------------------------------------------*/
+// Every lookup in the backend reads from the storage, so fewer are done.
+#define BENCH_BACKEND_ITERATIONS    (CONFIG_INDEX_BENCH_ITERATIONS / 100)
+
+#define BENCH_DOMAIN_NAME           "Bench"
+
+#define BENCH_ARRAY_SIZE(_a_)       (sizeof(_a_) / sizeof((_a_)[0]))
+
+//------------------------------------------------------------------------------
+static const if_OS_Timer_t timer =
+    IF_OS_TIMER_ASSIGN(
+        timeServer_rpc,
+        timeServer_notify);
+
+static const size_t parameterCounts[] =
+{
+    8, 32, 128, CONFIG_INDEX_MAX_PARAMETERS
+};
+
+static ConfigIndex_t benchIndex;
+static char names[CONFIG_INDEX_MAX_PARAMETERS][OS_CONFIG_LIB_PARAMETER_NAME_SIZE];
+
+// Results are accumulated here, so the compiler can't drop the measured work.
+static volatile uintptr_t sink;
+
+
+//==============================================================================
+// helper functions
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static uint64_t
+getTimeNs(void)
+{
+    uint64_t ns;
+
+    OS_Error_t err = TimeServer_getTime(
+                         &timer,
+                         TimeServer_PRECISION_NSEC,
+                         &ns);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("TimeServer_getTime() failed , code '%s'",
+                        Debug_OS_Error_toString(err));
+        ns = 0;
+    }
+
+    return ns;
+}
+
+//------------------------------------------------------------------------------
+static void
+report(
+    const char* name,
+    size_t      numParameters,
+    uint64_t    start,
+    uint64_t    end,
+    size_t      iterations)
+{
+    unsigned long long nsPerOp = (end - start) / iterations;
+
+    Debug_LOG_INFO("bench %-18s %4zu params: %8llu ns/op",
+                   name, numParameters, nsPerOp);
+}
+
+//------------------------------------------------------------------------------
+static OS_Error_t
+fillBenchIndex(
+    size_t numParameters)
+{
+    static const OS_ConfigServiceLibTypes_Domain_t domain;
+    static const OS_ConfigServiceLibTypes_DomainEnumerator_t domainEnumerator;
+    static const OS_ConfigServiceLibTypes_Parameter_t parameter;
+    static const OS_ConfigServiceLibTypes_ParameterEnumerator_t parameterEnumerator;
+
+    ConfigIndex_init(&benchIndex);
+
+    OS_Error_t err = ConfigIndex_addDomain(
+                         &benchIndex,
+                         BENCH_DOMAIN_NAME,
+                         &domain,
+                         &domainEnumerator);
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    for (size_t i = 0; i < numParameters; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "Parameter_%04zu", i);
+
+        err = ConfigIndex_addParameter(
+                  &benchIndex,
+                  names[i],
+                  &parameter,
+                  &parameterEnumerator);
+        if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+    }
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static const ConfigIndex_Parameter_t*
+findLinear(
+    const ConfigIndex_t*        index,
+    const ConfigIndex_Domain_t* domain,
+    const char*                 parameterName)
+{
+    for (size_t i = 0; i < domain->numParameters; i++)
+    {
+        const ConfigIndex_Parameter_t* entry =
+            &index->parameters[domain->firstParameter + i];
+        if (0 == strncmp(entry->name,
+                         parameterName,
+                         OS_CONFIG_LIB_PARAMETER_NAME_SIZE))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+//==============================================================================
+// benchmarks
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void
+bench_synthetic(void)
+{
+    for (size_t c = 0; c < BENCH_ARRAY_SIZE(parameterCounts); c++)
+    {
+        size_t numParameters = parameterCounts[c];
+
+        OS_Error_t err = fillBenchIndex(numParameters);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("fillBenchIndex() failed with: %d", err);
+            return;
+        }
+
+        const ConfigIndex_Domain_t* domain =
+            ConfigIndex_findDomain(&benchIndex, BENCH_DOMAIN_NAME);
+
+        uint64_t start = getTimeNs();
+        for (size_t i = 0; i < CONFIG_INDEX_BENCH_ITERATIONS; i++)
+        {
+            sink += (uintptr_t)ConfigIndex_findParameter(
+                        &benchIndex,
+                        domain,
+                        names[i % numParameters]);
+        }
+        uint64_t end = getTimeNs();
+        report("index_lookup", numParameters, start, end,
+               CONFIG_INDEX_BENCH_ITERATIONS);
+
+        start = getTimeNs();
+        for (size_t i = 0; i < CONFIG_INDEX_BENCH_ITERATIONS; i++)
+        {
+            sink += (uintptr_t)findLinear(
+                        &benchIndex,
+                        domain,
+                        names[i % numParameters]);
+        }
+        end = getTimeNs();
+        report("linear_lookup", numParameters, start, end,
+               CONFIG_INDEX_BENCH_ITERATIONS);
+    }
+}
+
+//------------------------------------------------------------------------------
+static void
+bench_backend(
+    OS_ConfigServiceHandle_t handle)
+{
+    const ConfigIndex_t* index = ConfigIndex_getInstance();
+
+    if (0 == index->numParameters)
+    {
+        Debug_LOG_WARNING("No parameters indexed, skipping backend benchmark");
+        return;
+    }
+
+    uint64_t start = getTimeNs();
+    for (size_t i = 0; i < BENCH_BACKEND_ITERATIONS; i++)
+    {
+        const ConfigIndex_Parameter_t* entry =
+            &index->parameters[i % index->numParameters];
+        const ConfigIndex_Domain_t* domain = &index->domains[entry->domainIdx];
+
+        sink += (uintptr_t)ConfigIndex_findParameter(index, domain, entry->name);
+    }
+    uint64_t end = getTimeNs();
+    report("index_backend", index->numParameters, start, end,
+           BENCH_BACKEND_ITERATIONS);
+
+    start = getTimeNs();
+    for (size_t i = 0; i < BENCH_BACKEND_ITERATIONS; i++)
+    {
+        const ConfigIndex_Parameter_t* entry =
+            &index->parameters[i % index->numParameters];
+        const ConfigIndex_Domain_t* domain = &index->domains[entry->domainIdx];
+
+        OS_ConfigServiceLibTypes_ParameterName_t name;
+        OS_ConfigServiceLibTypes_Parameter_t parameter;
+
+        memcpy(name.name, entry->name, sizeof(name.name));
+        OS_Error_t err = OS_ConfigService_domainGetElement(
+                             handle,
+                             &domain->domain,
+                             &name,
+                             &parameter);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("OS_ConfigService_domainGetElement() failed with: %d",
+                            err);
+            return;
+        }
+    }
+    end = getTimeNs();
+    report("library_backend", index->numParameters, start, end,
+           BENCH_BACKEND_ITERATIONS);
+}
+
+
+//==============================================================================
+// public functions
+//==============================================================================
+
+//------------------------------------------------------------------------------
+void
+ConfigIndex_bench_run(
+    OS_ConfigServiceHandle_t handle)
+{
+    Debug_LOG_INFO("Running ConfigServer lookup benchmarks, %d iterations",
+                   CONFIG_INDEX_BENCH_ITERATIONS);
+
+    bench_synthetic();
+    bench_backend(handle);
+
+    Debug_LOG_INFO("ConfigServer lookup benchmarks done");
+}
@@ -0,0 +1,26 @@
+/*
+ * ConfigServer lookup benchmarks
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "OS_ConfigService.h"
+
+// Number of lookups per benchmark case. The time is taken only once for all
+// lookups, so the TimeServer RPC overhead is amortized.
+#if !defined(CONFIG_INDEX_BENCH_ITERATIONS)
+#define CONFIG_INDEX_BENCH_ITERATIONS   10000
+#endif
+
+// Compare the lookup latency of the hash index with the linear lookup of the
+// config library for a growing number of parameters and log the results as
+// ns/op.
+void
+ConfigIndex_bench_run(
+    OS_ConfigServiceHandle_t handle);
@@ -0,0 +1,125 @@
+/*
+ * Log levels of the components, kept in the Domain-Logging of the ConfigServer.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <string.h>
+#include <camkes.h>
+
+#include "lib_debug/Debug.h"
+#include "config_index.h"
+#include "config_log_levels.h"
+#include "config_params.h"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+    const char*     parameterName;
+    unsigned int    clientId;
+} ConfigLogLevels_Client_t;
+
+// the client id is the logger id of the component in the LogServer
+static const ConfigLogLevels_Client_t clients[] =
+{
+    {
+        .parameterName  = CONFIG_LOGGING_CONFIG_SERVER_NAME,
+        .clientId       = CONFIGSERVER_LOGGER_ID
+    },
+    {
+        .parameterName  = CONFIG_LOGGING_CLOUD_CONNECTOR_NAME,
+        .clientId       = CLOUDCONNECTOR_LOGGER_ID
+    },
+    {
+        .parameterName  = CONFIG_LOGGING_SENSOR_NAME,
+        .clientId       = SENSOR_LOGGER_ID
+    },
+    {
+        .parameterName  = CONFIG_LOGGING_NIC_NAME,
+        .clientId       = NIC_LOGGER_ID
+    },
+    {
+        .parameterName  = CONFIG_LOGGING_NW_STACK_NAME,
+        .clientId       = NWSTACK_LOGGER_ID
+    },
+};
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+bool
+ConfigLogLevels_isDomain(
+    const char* domainName)
+{
+    return (strcmp(domainName, CONFIG_LOGGING_NAME) == 0);
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigLogLevels_push(
+    OS_ConfigServiceHandle_t handle)
+{
+    const ConfigIndex_t* index = ConfigIndex_getInstance();
+    const ConfigIndex_Domain_t* domain =
+        ConfigIndex_findDomain(index, CONFIG_LOGGING_NAME);
+    if (NULL == domain)
+    {
+        Debug_LOG_WARNING("Domain %s not found, log levels are not set",
+                          CONFIG_LOGGING_NAME);
+        return OS_ERROR_CONFIG_DOMAIN_NOT_FOUND;
+    }
+
+    OS_Error_t result = OS_SUCCESS;
+
+    for (size_t i = 0; i < (sizeof(clients) / sizeof(clients[0])); i++)
+    {
+        const ConfigIndex_Parameter_t* entry =
+            ConfigIndex_findParameter(index, domain, clients[i].parameterName);
+        if (NULL == entry)
+        {
+            Debug_LOG_WARNING("Log level %s not found",
+                              clients[i].parameterName);
+            result = OS_ERROR_CONFIG_PARAMETER_NOT_FOUND;
+            continue;
+        }
+
+        int32_t level;
+        size_t bytesCopied;
+        OS_Error_t err = OS_ConfigService_parameterGetValue(
+                             handle,
+                             &entry->parameter,
+                             &level,
+                             sizeof(level),
+                             &bytesCopied);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("OS_ConfigService_parameterGetValue() for %s failed with: %d",
+                            clients[i].parameterName, err);
+            result = err;
+            continue;
+        }
+
+        if (level < 0)
+        {
+            Debug_LOG_ERROR("Invalid log level %d for %s",
+                            (int)level, clients[i].parameterName);
+            result = OS_ERROR_INVALID_PARAMETER;
+            continue;
+        }
+
+        err = logServerCtrl_rpc_setLevel(clients[i].clientId,
+                                         (unsigned int)level);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("logServerCtrl_rpc_setLevel() for %s failed with: %d",
+                            clients[i].parameterName, err);
+            result = err;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,28 @@
+/*
+ * Log levels of the components, kept in the Domain-Logging of the ConfigServer.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "OS_ConfigService.h"
+
+// Check if a domain is the one with the log levels.
+bool
+ConfigLogLevels_isDomain(
+    const char* domainName);
+
+// Pass the log levels of all components to the LogServer, which filters the
+// entries of the components with them and passes them on to the emitters of
+// the components with a log ring. A level that cannot be read or set is
+// skipped, its component keeps the level it has.
+OS_Error_t
+ConfigLogLevels_push(
+    OS_ConfigServiceHandle_t handle);
@@ -0,0 +1,228 @@
+/*
+ * Publishing of the parameter snapshot of the ConfigServer.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <camkes.h>
+
+#include "lib_debug/Debug.h"
+#include "config_index.h"
+#include "config_publish.h"
+#include "config_snapshot.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define SNAPSHOT_ALIGN(_size_) \
+    (((_size_) + (ConfigSnapshot_DATA_ALIGN - 1)) \
+     & ~((size_t)ConfigSnapshot_DATA_ALIGN - 1))
+
+// A reader compares names up to their maximum size, so this much space is
+// kept free behind the data area.
+#define SNAPSHOT_USABLE_SIZE \
+    (CONFIG_SNAPSHOT_SIZE - ConfigSnapshot_MAX_NAME_SIZE)
+
+/* Private variables ---------------------------------------------------------*/
+// Reading the values from the backends may take milliseconds if they are read
+// from the SD card, so the snapshot is built here and the readers only have to
+// wait for the copy into the dataport.
+static uint8_t staging[CONFIG_SNAPSHOT_SIZE];
+
+// Private functions -----------------------------------------------------------
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+appendName(
+    uint8_t* snapshot,
+    size_t* used,
+    const char* name,
+    size_t maxLen,
+    uint32_t* nameOffset)
+{
+    size_t len = strnlen(name, maxLen - 1) + 1;
+    size_t size = SNAPSHOT_ALIGN(len);
+
+    if (size > (SNAPSHOT_USABLE_SIZE - *used))
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    memset(&snapshot[*used], 0, size);
+    memcpy(&snapshot[*used], name, len - 1);
+    *nameOffset = *used;
+    *used += size;
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+appendValue(
+    OS_ConfigServiceHandle_t handle,
+    uint8_t* snapshot,
+    size_t* used,
+    const ConfigIndex_Parameter_t* parameter,
+    ConfigSnapshot_Entry_t* entry)
+{
+    size_t valueSize = OS_ConfigService_parameterGetSize(&parameter->parameter);
+    size_t size = SNAPSHOT_ALIGN(valueSize);
+
+    if (size > (SNAPSHOT_USABLE_SIZE - *used))
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    OS_ConfigServiceLibTypes_ParameterType_t type;
+    OS_ConfigService_parameterGetType(&parameter->parameter, &type);
+
+    memset(&snapshot[*used], 0, size);
+
+    size_t bytesCopied;
+    OS_Error_t err = OS_ConfigService_parameterGetValue(
+                         handle,
+                         &parameter->parameter,
+                         &snapshot[*used],
+                         valueSize,
+                         &bytesCopied);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigService_parameterGetValue() for %s failed with: %d",
+                        parameter->name, err);
+        return err;
+    }
+
+    entry->type        = type;
+    entry->valueOffset = *used;
+    entry->valueSize   = valueSize;
+    *used += size;
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+writeSnapshot(
+    OS_ConfigServiceHandle_t handle,
+    uint8_t* snapshot,
+    const ConfigIndex_t* index)
+{
+    ConfigSnapshot_Header_t* header = (ConfigSnapshot_Header_t*)snapshot;
+    ConfigSnapshot_Domain_t* domains = (ConfigSnapshot_Domain_t*)&header[1];
+    ConfigSnapshot_Entry_t* entries =
+        (ConfigSnapshot_Entry_t*)&domains[index->numDomains];
+
+    size_t used = (uint8_t*)&entries[index->numParameters] - snapshot;
+    if (used > SNAPSHOT_USABLE_SIZE)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    header->numDomains = index->numDomains;
+    header->numEntries = index->numParameters;
+    header->dataOffset = used;
+
+    for (size_t i = 0; i < index->numDomains; i++)
+    {
+        const ConfigIndex_Domain_t* domain = &index->domains[i];
+
+        domains[i].hash = ConfigSnapshot_hashName(
+                              domain->name,
+                              sizeof(domain->name));
+        domains[i].firstEntry = domain->firstParameter;
+        domains[i].numEntries = domain->numParameters;
+        domains[i].version    = domain->version;
+
+        OS_Error_t err = appendName(
+                             snapshot,
+                             &used,
+                             domain->name,
+                             sizeof(domain->name),
+                             &domains[i].nameOffset);
+        if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+    }
+
+    for (size_t i = 0; i < index->numParameters; i++)
+    {
+        const ConfigIndex_Parameter_t* parameter = &index->parameters[i];
+
+        entries[i].hash = ConfigSnapshot_hashName(
+                              parameter->name,
+                              sizeof(parameter->name));
+
+        OS_Error_t err = appendName(
+                             snapshot,
+                             &used,
+                             parameter->name,
+                             sizeof(parameter->name),
+                             &entries[i].nameOffset);
+        if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+
+        err = appendValue(handle, snapshot, &used, parameter, &entries[i]);
+        if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+    }
+
+    header->dataSize = used - header->dataOffset;
+    header->magic = ConfigSnapshot_MAGIC;
+
+    return OS_SUCCESS;
+}
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigPublish_snapshot(
+    OS_ConfigServiceHandle_t handle)
+{
+    uint8_t* snapshot = (uint8_t*)configSnapshot_port;
+    ConfigSnapshot_Header_t* header = (ConfigSnapshot_Header_t*)snapshot;
+    const ConfigSnapshot_Header_t* staged =
+        (const ConfigSnapshot_Header_t*)staging;
+
+    // the readers keep the published snapshot if this fails
+    OS_Error_t err = writeSnapshot(handle, staging, ConfigIndex_getInstance());
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("writeSnapshot() failed with: %d", err);
+        return err;
+    }
+
+    // an odd version tells the readers that an update is in progress
+    uint32_t version = header->version;
+    __atomic_store_n(&header->version, version + 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    // everything but the version, which belongs to the dataport
+    size_t size = staged->dataOffset + staged->dataSize;
+    memcpy(&snapshot[sizeof(*header)],
+           &staging[sizeof(*header)],
+           size - sizeof(*header));
+    memcpy(&header->numDomains,
+           &staged->numDomains,
+           sizeof(*header) - offsetof(ConfigSnapshot_Header_t, numDomains));
+    header->magic = staged->magic;
+
+    __atomic_store_n(&header->version, version + 2, __ATOMIC_RELEASE);
+
+    Debug_LOG_INFO("Published config snapshot version %u, %zu bytes",
+                   version + 2, size);
+
+    return OS_SUCCESS;
+}
@@ -0,0 +1,20 @@
+/*
+ * Publishing of the parameter snapshot of the ConfigServer.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "OS_ConfigService.h"
+
+// Write all indexed parameters into the snapshot dataport and increment its
+// version. Clients that read during the update notice the changing version
+// and repeat their read.
+OS_Error_t
+ConfigPublish_snapshot(
+    OS_ConfigServiceHandle_t handle);
@@ -9,6 +9,8 @@
 #include <camkes.h>
 
 #include "init_config_backend.h"
+#include "config_index.h"
+#include "config_image.h"
 
 
 /* Defines -------------------------------------------------------------------*/
@@ -16,6 +18,8 @@
 #define DOMAIN_FILE "DOMAIN.BIN"
 #define STRING_FILE "STRING.BIN"
 #define BLOB_FILE "BLOB.BIN"
+#define IMAGE_FILE "CONFIG.IMG"
+#define IMAGE_FILE_B "CONFIG_B.IMG"
 
 
 /* Private types -------------------------------------------------------------*/
@@ -36,6 +40,642 @@ void initializeName(char* buf, size_t bufSize, char const* name)
     strncpy(buf, name, bufSize - 1);
 }
 
+#if defined(CONFIG_BACKEND_RAM)
+
+// In the RAM mode the four tables are copied from their files into memory
+// backends, which the config library then reads from. The shadow holds the
+// records as they are stored in the file, so a sync writes back just the
+// records that have changed in memory. If the tables are loaded from the
+// config image, the shadow is the section of the table in the image.
+//
+// Only the setParameter() RPC of the bulk interface changes the tables and it
+// syncs them right away. No client is connected to the OS_ConfigServiceServer
+// interface of the config library, whose writes would only reach the RAM.
+typedef struct
+{
+    char const*                 fileName;
+    ConfigImage_SectionType_t   imageSection;
+    OS_ConfigServiceBackend_t   fileBackend;
+    OS_ConfigServiceBackend_t   memBackend;
+    uint8_t*                    shadow;
+    unsigned int                numberOfRecords;
+    size_t                      sizeOfRecord;
+} RamTable_t;
+
+enum
+{
+    RAM_TABLE_PARAMETER,
+    RAM_TABLE_DOMAIN,
+    RAM_TABLE_STRING,
+    RAM_TABLE_BLOB,
+    RAM_TABLE_NUM
+};
+
+static RamTable_t ramTables[RAM_TABLE_NUM] =
+{
+    [RAM_TABLE_PARAMETER]   = { PARAMETER_FILE, ConfigImage_SECTION_PARAMETER },
+    [RAM_TABLE_DOMAIN]      = { DOMAIN_FILE,    ConfigImage_SECTION_DOMAIN },
+    [RAM_TABLE_STRING]      = { STRING_FILE,    ConfigImage_SECTION_STRING },
+    [RAM_TABLE_BLOB]        = { BLOB_FILE,      ConfigImage_SECTION_BLOB },
+};
+
+static uint8_t  ramPool[CONFIG_BACKEND_RAM_SIZE];
+static size_t   ramPoolUsed;
+static uint8_t* recordBuf;
+
+static
+uint8_t* allocateRam(size_t size)
+{
+    // keep the records word aligned
+    size = (size + (sizeof(uint32_t) - 1)) & ~(sizeof(uint32_t) - 1);
+
+    if (size > (sizeof(ramPool) - ramPoolUsed))
+    {
+        Debug_LOG_ERROR("RAM backend needs %zu more bytes, %zu are left",
+                        size, sizeof(ramPool) - ramPoolUsed);
+        return NULL;
+    }
+
+    uint8_t* mem = &ramPool[ramPoolUsed];
+    ramPoolUsed += size;
+
+    return mem;
+}
+
+// Create the memory backend of a table and copy the records from the shadow
+// into it. The number and size of the records must be set. createMemBackend()
+// formats the memory, initializeMemBackend() attaches the backend to it.
+static
+OS_Error_t createRamTable(RamTable_t* table)
+{
+    size_t tableSize = table->numberOfRecords * table->sizeOfRecord;
+    size_t memSize = CONFIG_BACKEND_RAM_HEADER_SIZE + tableSize;
+
+    uint8_t* mem = allocateRam(memSize);
+    if (NULL == mem)
+    {
+        Debug_LOG_ERROR("No RAM for %s with %u records of %zu bytes",
+                        table->fileName, table->numberOfRecords,
+                        table->sizeOfRecord);
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    OS_Error_t err = OS_ConfigServiceBackend_createMemBackend(
+                         mem,
+                         memSize,
+                         table->numberOfRecords,
+                         table->sizeOfRecord);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigServiceBackend_createMemBackend() for %s failed with: %d",
+                        table->fileName, err);
+        return err;
+    }
+
+    err = OS_ConfigServiceBackend_initializeMemBackend(
+              &table->memBackend,
+              mem,
+              memSize);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigServiceBackend_initializeMemBackend() for %s failed with: %d",
+                        table->fileName, err);
+        return err;
+    }
+
+    for (unsigned int i = 0; i < table->numberOfRecords; i++)
+    {
+        err = OS_ConfigServiceBackend_writeRecord(
+                  &table->memBackend,
+                  i,
+                  &table->shadow[i * table->sizeOfRecord],
+                  table->sizeOfRecord);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("OS_ConfigServiceBackend_writeRecord() for record %u of %s failed with: %d",
+                            i, table->fileName, err);
+            return err;
+        }
+    }
+
+    return OS_SUCCESS;
+}
+
+static
+OS_Error_t loadRamTable(RamTable_t* table,
+                        OS_FileSystem_Handle_t hFs)
+{
+    OS_ConfigServiceBackend_FileName_t name;
+
+    initializeName(
+        name.buffer,
+        OS_CONFIG_BACKEND_MAX_FILE_NAME_SIZE,
+        table->fileName);
+    OS_Error_t err = OS_ConfigServiceBackend_initializeFileBackend(
+                         &table->fileBackend,
+                         name,
+                         hFs);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigServiceBackend_initializeFileBackend() for file %s failed with: %d",
+                        name.buffer, err);
+        return err;
+    }
+
+    table->numberOfRecords =
+        OS_ConfigServiceBackend_getNumberOfRecords(&table->fileBackend);
+    table->sizeOfRecord =
+        OS_ConfigServiceBackend_getSizeOfRecords(&table->fileBackend);
+
+    table->shadow = allocateRam(table->numberOfRecords * table->sizeOfRecord);
+    if (NULL == table->shadow)
+    {
+        Debug_LOG_ERROR("No RAM for %s with %u records of %zu bytes",
+                        table->fileName, table->numberOfRecords,
+                        table->sizeOfRecord);
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    for (unsigned int i = 0; i < table->numberOfRecords; i++)
+    {
+        err = OS_ConfigServiceBackend_readRecord(
+                  &table->fileBackend,
+                  i,
+                  &table->shadow[i * table->sizeOfRecord],
+                  table->sizeOfRecord);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("OS_ConfigServiceBackend_readRecord() for record %u of %s failed with: %d",
+                            i, table->fileName, err);
+            return err;
+        }
+    }
+
+    err = createRamTable(table);
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    Debug_LOG_DEBUG("Loaded %u records of %zu bytes from %s",
+                    table->numberOfRecords, table->sizeOfRecord,
+                    table->fileName);
+
+    return OS_SUCCESS;
+}
+
+#if defined(CONFIG_BACKEND_IMAGE)
+
+// The image stays in memory, it holds the shadows of the tables. It is kept
+// in two slots on the file system, a change is always written to the slot the
+// image was not loaded from or last written to. A write that is torn by a
+// reset thus leaves the other slot intact, on start-up the valid slot with the
+// higher generation is loaded. A slot only gets the chunks that have changed
+// since it was written last, the chunk with the header and the CRC goes last.
+#define IMAGE_CHUNK_SIZE    512
+#define IMAGE_MAX_CHUNKS    \
+    ((CONFIG_BACKEND_IMAGE_SIZE + IMAGE_CHUNK_SIZE - 1) / IMAGE_CHUNK_SIZE)
+#define IMAGE_NUM_SLOTS     2
+
+typedef struct
+{
+    char const* fileName;
+    bool        isInSync;   // holds an earlier generation of this image
+    uint32_t    dirty[(IMAGE_MAX_CHUNKS + 31) / 32];
+} ImageSlot_t;
+
+static ImageSlot_t imageSlots[IMAGE_NUM_SLOTS] =
+{
+    { IMAGE_FILE },
+    { IMAGE_FILE_B },
+};
+
+static uint8_t*                 image;  // allocated from the RAM pool
+static size_t                   imageSize;
+static size_t                   imageSlot;
+static bool                     isImageLoaded;
+static OS_FileSystem_Handle_t   hImageFs;
+
+static
+OS_Error_t readImageHeader(OS_FileSystem_Handle_t hFs,
+                           ImageSlot_t const* slot,
+                           ConfigImage_Header_t* header)
+{
+    off_t size;
+
+    OS_Error_t err = OS_FileSystemFile_getSize(hFs, slot->fileName, &size);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_DEBUG("OS_FileSystemFile_getSize() for %s failed with: %d",
+                        slot->fileName, err);
+        return err;
+    }
+
+    if ((size < sizeof(*header)) || (size > CONFIG_BACKEND_IMAGE_SIZE))
+    {
+        Debug_LOG_ERROR("%s has %lld bytes, max is %u",
+                        slot->fileName, (long long)size,
+                        CONFIG_BACKEND_IMAGE_SIZE);
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    OS_FileSystemFile_Handle_t hFile;
+    err = OS_FileSystemFile_open(
+              hFs,
+              &hFile,
+              slot->fileName,
+              OS_FileSystem_OpenMode_RDONLY,
+              OS_FileSystem_OpenFlags_NONE);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_FileSystemFile_open() for %s failed with: %d",
+                        slot->fileName, err);
+        return err;
+    }
+
+    err = OS_FileSystemFile_read(hFs, hFile, 0, sizeof(*header), header);
+    OS_FileSystemFile_close(hFs, hFile);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_FileSystemFile_read() for %s failed with: %d",
+                        slot->fileName, err);
+        return err;
+    }
+
+    // the whole image is checked by ConfigImage_validate() once it is loaded
+    if ((header->magic != ConfigImage_MAGIC)
+        || (header->imageSize != size))
+    {
+        Debug_LOG_ERROR("%s has no valid header", slot->fileName);
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    return OS_SUCCESS;
+}
+
+static
+OS_Error_t readImage(OS_FileSystem_Handle_t hFs,
+                     ImageSlot_t const* slot,
+                     size_t size)
+{
+    OS_FileSystemFile_Handle_t hFile;
+    OS_Error_t err = OS_FileSystemFile_open(
+                         hFs,
+                         &hFile,
+                         slot->fileName,
+                         OS_FileSystem_OpenMode_RDONLY,
+                         OS_FileSystem_OpenFlags_NONE);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_FileSystemFile_open() for %s failed with: %d",
+                        slot->fileName, err);
+        return err;
+    }
+
+    err = OS_FileSystemFile_read(hFs, hFile, 0, size, image);
+    OS_FileSystemFile_close(hFs, hFile);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_FileSystemFile_read() for %s failed with: %d",
+                        slot->fileName, err);
+        return err;
+    }
+
+    err = ConfigImage_validate(image, size);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("ConfigImage_validate() for %s failed with: %d",
+                        slot->fileName, err);
+        return err;
+    }
+
+    return OS_SUCCESS;
+}
+
+// Load the valid slot with the higher generation into a buffer from the RAM
+// pool. The buffer is given back to the pool if no slot is valid.
+static
+OS_Error_t loadImage(OS_FileSystem_Handle_t hFs)
+{
+    ConfigImage_Header_t headers[IMAGE_NUM_SLOTS];
+    bool isCandidate[IMAGE_NUM_SLOTS];
+    size_t maxSize = 0;
+
+    for (size_t i = 0; i < IMAGE_NUM_SLOTS; i++)
+    {
+        isCandidate[i] =
+            (OS_SUCCESS == readImageHeader(hFs, &imageSlots[i], &headers[i]));
+        if (isCandidate[i] && (headers[i].imageSize > maxSize))
+        {
+            maxSize = headers[i].imageSize;
+        }
+    }
+
+    if (0 == maxSize)
+    {
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    // try the newer slot first
+    size_t order[IMAGE_NUM_SLOTS] = { 0, 1 };
+    if (isCandidate[0] && isCandidate[1]
+        && ConfigImage_isNewer(headers[1].generation, headers[0].generation))
+    {
+        order[0] = 1;
+        order[1] = 0;
+    }
+
+    size_t poolMark = ramPoolUsed;
+    image = allocateRam(maxSize);
+    if (NULL == image)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    for (size_t i = 0; i < IMAGE_NUM_SLOTS; i++)
+    {
+        size_t slot = order[i];
+
+        if (isCandidate[slot]
+            && (OS_SUCCESS == readImage(hFs, &imageSlots[slot],
+                                        headers[slot].imageSize)))
+        {
+            imageSize = headers[slot].imageSize;
+            imageSlot = slot;
+            imageSlots[slot].isInSync = true;
+            hImageFs = hFs;
+
+            Debug_LOG_INFO("Loaded %s with %zu bytes, generation %u",
+                           imageSlots[slot].fileName, imageSize,
+                           headers[slot].generation);
+
+            return OS_SUCCESS;
+        }
+    }
+
+    ramPoolUsed = poolMark;
+    image = NULL;
+
+    return OS_ERROR_INVALID_PARAMETER;
+}
+
+static
+OS_Error_t loadRamTableFromImage(RamTable_t* table)
+{
+    const ConfigImage_Section_t* section =
+        ConfigImage_getSection(image, table->imageSection);
+
+    table->numberOfRecords = section->numRecords;
+    table->sizeOfRecord = section->sizeOfRecord;
+    table->shadow = ConfigImage_getRecords(image, section);
+
+    return createRamTable(table);
+}
+
+// Mark the chunks of a changed record as dirty in both slots.
+static
+void markImageDirty(const uint8_t* record, size_t size)
+{
+    size_t first = (record - image) / IMAGE_CHUNK_SIZE;
+    size_t last = (record - image + size - 1) / IMAGE_CHUNK_SIZE;
+
+    for (size_t slot = 0; slot < IMAGE_NUM_SLOTS; slot++)
+    {
+        for (size_t chunk = first; chunk <= last; chunk++)
+        {
+            imageSlots[slot].dirty[chunk / 32] |= (1U << (chunk % 32));
+        }
+    }
+}
+
+static
+bool isChunkDirty(ImageSlot_t const* slot, size_t chunk)
+{
+    return !slot->isInSync
+           || (slot->dirty[chunk / 32] & (1U << (chunk % 32)));
+}
+
+static
+OS_Error_t writeImageChunks(OS_FileSystemFile_Handle_t hFile,
+                            ImageSlot_t const* slot,
+                            size_t first,
+                            size_t end)
+{
+    size_t offset = first * IMAGE_CHUNK_SIZE;
+    size_t size = end * IMAGE_CHUNK_SIZE;
+    if (size > imageSize)
+    {
+        size = imageSize;
+    }
+    size -= offset;
+
+    OS_Error_t err = OS_FileSystemFile_write(hImageFs, hFile, offset, size,
+                                             &image[offset]);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_FileSystemFile_write() of %zu bytes at %zu to %s failed with: %d",
+                        size, offset, slot->fileName, err);
+    }
+
+    return err;
+}
+
+static
+OS_Error_t storeImage(void)
+{
+    size_t next = (imageSlot + 1) % IMAGE_NUM_SLOTS;
+    ImageSlot_t* slot = &imageSlots[next];
+    ConfigImage_Header_t* header = (ConfigImage_Header_t*)image;
+    size_t numChunks = (imageSize + IMAGE_CHUNK_SIZE - 1) / IMAGE_CHUNK_SIZE;
+
+    header->generation++;
+    ConfigImage_updateCrc(image);
+
+    OS_FileSystemFile_Handle_t hFile;
+    OS_Error_t err = OS_FileSystemFile_open(
+                         hImageFs,
+                         &hFile,
+                         slot->fileName,
+                         OS_FileSystem_OpenMode_RDWR,
+                         OS_FileSystem_OpenFlags_CREATE);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_FileSystemFile_open() for %s failed with: %d",
+                        slot->fileName, err);
+        return err;
+    }
+
+    // write the runs of dirty chunks after the header, then the header
+    for (size_t chunk = 1; (OS_SUCCESS == err) && (chunk < numChunks); chunk++)
+    {
+        if (!isChunkDirty(slot, chunk))
+        {
+            continue;
+        }
+
+        size_t first = chunk;
+        while ((chunk < numChunks) && isChunkDirty(slot, chunk))
+        {
+            chunk++;
+        }
+
+        err = writeImageChunks(hFile, slot, first, chunk);
+    }
+
+    if (OS_SUCCESS == err)
+    {
+        err = writeImageChunks(hFile, slot, 0, 1);
+    }
+
+    OS_FileSystemFile_close(hImageFs, hFile);
+    if (err != OS_SUCCESS)
+    {
+        // the content of the slot is unknown now, write it as a whole next time
+        slot->isInSync = false;
+        return err;
+    }
+
+    memset(slot->dirty, 0, sizeof(slot->dirty));
+    slot->isInSync = true;
+    imageSlot = next;
+
+    Debug_LOG_DEBUG("Wrote %s, generation %u", slot->fileName,
+                    header->generation);
+
+    return OS_SUCCESS;
+}
+
+#endif // defined(CONFIG_BACKEND_IMAGE)
+
+static
+OS_Error_t loadTable(RamTable_t* table,
+                     OS_FileSystem_Handle_t hFs)
+{
+#if defined(CONFIG_BACKEND_IMAGE)
+    if (isImageLoaded)
+    {
+        return loadRamTableFromImage(table);
+    }
+#endif
+
+    return loadRamTable(table, hFs);
+}
+
+static
+OS_Error_t syncRamTable(RamTable_t* table, bool* hasChanged)
+{
+    for (unsigned int i = 0; i < table->numberOfRecords; i++)
+    {
+        uint8_t* record = &table->shadow[i * table->sizeOfRecord];
+
+        OS_Error_t err = OS_ConfigServiceBackend_readRecord(
+                             &table->memBackend,
+                             i,
+                             recordBuf,
+                             table->sizeOfRecord);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("OS_ConfigServiceBackend_readRecord() for record %u of %s failed with: %d",
+                            i, table->fileName, err);
+            return err;
+        }
+
+        if (0 == memcmp(recordBuf, record, table->sizeOfRecord))
+        {
+            continue;
+        }
+
+#if defined(CONFIG_BACKEND_IMAGE)
+        // the changed chunks of the image are written once all tables are
+        // synced
+        if (!isImageLoaded)
+#endif
+        {
+            err = OS_ConfigServiceBackend_writeRecord(
+                      &table->fileBackend,
+                      i,
+                      recordBuf,
+                      table->sizeOfRecord);
+            if (err != OS_SUCCESS)
+            {
+                Debug_LOG_ERROR("OS_ConfigServiceBackend_writeRecord() for record %u of %s failed with: %d",
+                                i, table->fileName, err);
+                return err;
+            }
+        }
+
+        memcpy(record, recordBuf, table->sizeOfRecord);
+#if defined(CONFIG_BACKEND_IMAGE)
+        if (isImageLoaded)
+        {
+            markImageDirty(record, table->sizeOfRecord);
+        }
+#endif
+        *hasChanged = true;
+        Debug_LOG_DEBUG("Wrote record %u of %s", i, table->fileName);
+    }
+
+    return OS_SUCCESS;
+}
+
+static
+OS_Error_t initializeRamBackends(OS_ConfigServiceLib_t* configLib,
+                                 OS_FileSystem_Handle_t hFs)
+{
+    Debug_LOG_INFO("Initializing RAM backends...");
+
+#if defined(CONFIG_BACKEND_IMAGE)
+    isImageLoaded = (OS_SUCCESS == loadImage(hFs));
+    if (!isImageLoaded)
+    {
+        Debug_LOG_WARNING("No valid %s or %s, loading the table files",
+                          IMAGE_FILE, IMAGE_FILE_B);
+    }
+#endif
+
+    size_t maxSizeOfRecord = 0;
+    for (size_t i = 0; i < RAM_TABLE_NUM; i++)
+    {
+        OS_Error_t err = loadTable(&ramTables[i], hFs);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("loadTable() for %s failed with: %d",
+                            ramTables[i].fileName, err);
+            return err;
+        }
+
+        if (ramTables[i].sizeOfRecord > maxSizeOfRecord)
+        {
+            maxSizeOfRecord = ramTables[i].sizeOfRecord;
+        }
+    }
+
+    recordBuf = allocateRam(maxSizeOfRecord);
+    if (NULL == recordBuf)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    OS_Error_t err = OS_ConfigServiceLib_Init(
+                         configLib,
+                         &ramTables[RAM_TABLE_PARAMETER].memBackend,
+                         &ramTables[RAM_TABLE_DOMAIN].memBackend,
+                         &ramTables[RAM_TABLE_STRING].memBackend,
+                         &ramTables[RAM_TABLE_BLOB].memBackend);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigServiceLib_Init() failed with: %d", err);
+        return err;
+    }
+
+    Debug_LOG_INFO("RAM backends initialized, %zu of %zu bytes used.",
+                   ramPoolUsed, sizeof(ramPool));
+
+    return OS_SUCCESS;
+}
+
+#endif // defined(CONFIG_BACKEND_RAM)
+
 static
 OS_Error_t initializeFileBackends(OS_ConfigServiceLib_t* configLib,
                                   OS_FileSystem_Handle_t hFs)
@@ -152,12 +792,70 @@ init_system_config_backend(void)
     OS_ConfigServiceLib_t* configLib =
         OS_ConfigService_getInstance();
 
+#if defined(CONFIG_BACKEND_RAM)
+    err = initializeRamBackends(configLib, hFs);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("initializeRamBackends() failed with: %d", err);
+        return err;
+    }
+#else
     err = initializeFileBackends(configLib, hFs);
     if (err != OS_SUCCESS)
     {
         Debug_LOG_ERROR("initializeFileBackends() failed with: %d", err);
         return err;
     }
+#endif
+
+    OS_ConfigServiceHandle_t hConfig;
+    err = OS_ConfigService_createHandleLocal(&hConfig);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("OS_ConfigService_createHandleLocal() failed with: %d",
+                        err);
+        return err;
+    }
+
+    err = ConfigIndex_build(ConfigIndex_getInstance(), hConfig);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("ConfigIndex_build() failed with: %d", err);
+        return err;
+    }
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+sync_system_config_backend(void)
+{
+#if defined(CONFIG_BACKEND_RAM)
+    bool hasChanged = false;
+
+    for (size_t i = 0; i < RAM_TABLE_NUM; i++)
+    {
+        OS_Error_t err = syncRamTable(&ramTables[i], &hasChanged);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("syncRamTable() for %s failed with: %d",
+                            ramTables[i].fileName, err);
+            return err;
+        }
+    }
+
+#if defined(CONFIG_BACKEND_IMAGE)
+    if (isImageLoaded && hasChanged)
+    {
+        OS_Error_t err = storeImage();
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("storeImage() failed with: %d", err);
+            return err;
+        }
+    }
+#endif
+#endif
 
     return OS_SUCCESS;
 }
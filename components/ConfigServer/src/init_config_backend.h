@@ -13,4 +13,31 @@
 #include "OS_ConfigService.h"
 
 
+#if defined(CONFIG_BACKEND_RAM)
+
+// Size of the memory that holds the four config tables and the copies used
+// to detect the changed records, or the config image that holds the copies.
+#if !defined(CONFIG_BACKEND_RAM_SIZE)
+#define CONFIG_BACKEND_RAM_SIZE         (128 * 1024)
+#endif
+
+// Space reserved for the header of a memory backend in front of the records.
+#if !defined(CONFIG_BACKEND_RAM_HEADER_SIZE)
+#define CONFIG_BACKEND_RAM_HEADER_SIZE  64
+#endif
+
+// Maximum size of the config image, which replaces the four table files if
+// it is found on the file system. The image is loaded into the RAM pool.
+#if defined(CONFIG_BACKEND_IMAGE) && !defined(CONFIG_BACKEND_IMAGE_SIZE)
+#define CONFIG_BACKEND_IMAGE_SIZE       (64 * 1024)
+#endif
+
+#endif // defined(CONFIG_BACKEND_RAM)
+
 OS_Error_t init_system_config_backend();
+
+// Write the records that have changed in the RAM backends to their files.
+// Nothing needs to be done if the file backends are used directly. Every
+// write to the config library must be followed by this, otherwise the change
+// is lost with the next reboot.
+OS_Error_t sync_system_config_backend(void);
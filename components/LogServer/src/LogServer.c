@@ -14,52 +14,41 @@
 
 #include "Logger/Server/OS_LoggerFile.h"
 
-#include "Logger/Server/OS_LoggerConsumerChain.h"
 #include "Logger/Server/OS_LoggerConsumer.h"
 
 #include "Logger/Server/OS_LoggerOutputConsole.h"
-#include "Logger/Server/OS_LoggerOutputFileSystem.h"
 
 #include "Logger/Client/OS_LoggerEmitter.h"
 
 #include "OS_FileSystem.h"
 
 #include "custom_log_format.h"
+#include "binary_log_format.h"
+#include "log_dedup.h"
+#include "log_clients.h"
+#include "log_ring.h"
+#include "trace.h"
 
+#include <stdbool.h>
 #include <stdio.h>
 
 #include <camkes.h>
 
 
 /* Defines -------------------------------------------------------------------*/
-#define DATABUFFER_SERVER_01    (void *)configServer_port
-#define DATABUFFER_SERVER_02    (void *)cloudConnector_port
-#define DATABUFFER_SERVER_03    (void *)sensor_port
-#define DATABUFFER_SERVER_04    (void *)nwDriver_port
-#define DATABUFFER_SERVER_05    (void *)nwStack_port
-
 // log server id
 #define LOG_SERVER_ID               0
 
-// client id's
-#define CLIENT_CONFIGSRV_ID         10
-#define CLIENT_CLOUDCON_ID          20
-#define CLIENT_SENSORTEMP_ID        30
-#define CLIENT_NIC_ID               40
-#define CLIENT_NWSTACK_ID           50
-
 #define PARTITION_ID                1
-#define LOG_FILENAME                "log.txt"
+// the entries are stored as binary records in a ring of segment files, see
+// binary_log_format.h
+#define LOG_FILE_PREFIX             "log"
 
 uint32_t API_LOG_SERVER_GET_SENDER_ID(void);
 
-static OS_LoggerFilter_Handle_t filter_configSrv,
-       filter_cloudCon, filter_sensorTemp, filter_nic, filter_nwStack;
-static OS_LoggerConsumer_Handle_t log_consumer_configSrv,
-       log_consumer_cloudCon, log_consumer_sensorTemp, log_consumer_nic, log_consumer_nwStack;
 static OS_LoggerConsumerCallback_t log_consumer_callback;
 static OS_LoggerSubject_Handle_t subject;
-static OS_LoggerOutput_Handle_t filesystem, console;
+static OS_LoggerOutput_Handle_t dedup;
 static OS_LoggerFile_Handle_t log_file;
 
 // Emitter configuration
@@ -69,6 +58,77 @@ static OS_LoggerSubject_Handle_t subject_log_server;
 static OS_LoggerOutput_Handle_t console_log_server;
 static char buf_log_server[DATABUFFER_SIZE];
 
+// The formats behind the dedup stage, see log_dedup.h
+static OS_LoggerAbstractFormat_Handle_t* const log_formats[] =
+{
+    (OS_LoggerAbstractFormat_Handle_t*)&binary_log_format,
+    (OS_LoggerAbstractFormat_Handle_t*)&custom_log_format,
+};
+
+#define NUM_LOG_FORMATS     (sizeof(log_formats) / sizeof(log_formats[0]))
+
+// Log clients, see log_clients.h
+typedef struct
+{
+    uint32_t                    id;
+    const char*                 name;
+    void**                      port;
+    bool                        isRing;
+    uint8_t                     level;
+    OS_LoggerFilter_Handle_t    filter;
+    OS_LoggerConsumer_Handle_t  consumer;
+    uint32_t                    dropped;
+} LogClient_t;
+
+#define LOG_CLIENT_ENTRY(_id_, _name_, _port_, _isRing_, _level_)             \
+    {                                                                         \
+        .id     = (_id_),                                                     \
+        .name   = (_name_),                                                   \
+        .port   = (void**)&(_port_),                                          \
+        .isRing = (_isRing_),                                                 \
+        .level  = (_level_),                                                  \
+    },
+
+static LogClient_t log_clients[] =
+{
+    LOG_CLIENTS(LOG_CLIENT_ENTRY)
+};
+
+#define NUM_LOG_CLIENTS     (sizeof(log_clients) / sizeof(log_clients[0]))
+
+// The client of an emit RPC is looked up by its badge, which is its id.
+static LogClient_t* log_clients_by_id[LOG_CLIENTS_MAX_ID + 1];
+
+// Trace clients, see log_clients.h
+typedef struct
+{
+    uint32_t    id;
+    void**      port;
+    uint32_t    dropped;
+} TraceClient_t;
+
+#define TRACE_CLIENT_ENTRY(_id_, _port_)                                      \
+    {                                                                         \
+        .id     = (_id_),                                                     \
+        .port   = (void**)&(_port_),                                          \
+    },
+
+static TraceClient_t trace_clients[] =
+{
+    TRACE_CLIENTS(TRACE_CLIENT_ENTRY)
+};
+
+#define NUM_TRACE_CLIENTS   (sizeof(trace_clients) / sizeof(trace_clients[0]))
+
+#define TRACE_EVENTS_PER_RECORD                                               \
+    (BinaryLogFormat_MAX_TRACE_SIZE / sizeof(Trace_Event_t))
+
+// the events of a trace ring are stored from here
+static Trace_Event_t trace_events[TRACE_EVENTS_PER_RECORD];
+
+// the consumers of the ring clients process the entries from here
+static char ring_entry[DATABUFFER_SIZE];
+
 static OS_FileSystem_Handle_t hFs;
 static OS_FileSystem_Config_t cfgFs =
 {
@@ -116,25 +176,245 @@ err0:
     return err;
 }
 
+// The entries are stamped in ms, the text format shows the seconds only.
 static uint64_t
-get_time_sec(
+get_time_ms(
     void)
 {
     OS_Error_t err;
-    uint64_t sec;
+    uint64_t ms;
 
-    if ((err = TimeServer_getTime(&timer, TimeServer_PRECISION_SEC,
-                                  &sec)) != OS_SUCCESS)
+    if ((err = TimeServer_getTime(&timer, TimeServer_PRECISION_MSEC,
+                                  &ms)) != OS_SUCCESS)
     {
         Debug_LOG_ERROR("TimeServer_getTime() failed with %d", err);
-        sec = 0;
+        ms = 0;
+    }
+
+    return ms;
+}
+
+// Process the entries of all log rings, one of every ring in turn, until they
+// are empty. Errors are printed and not logged, like in run().
+static void
+drain_log_rings(
+    void* ctx)
+{
+    // a notification while the rings are drained must not get lost
+    int ret = logRing_notify_reg_callback(drain_log_rings, ctx);
+    if (0 != ret)
+    {
+        printf("logRing_notify_reg_callback() failed with %d\n", ret);
+    }
+
+    bool isEmpty;
+    do
+    {
+        isEmpty = true;
+
+        for (size_t i = 0; i < NUM_LOG_CLIENTS; i++)
+        {
+            LogClient_t* client = &log_clients[i];
+            if (!client->isRing)
+            {
+                continue;
+            }
+
+            LogRing_t* ring = *client->port;
+
+            if (LogRing_pop(ring, ring_entry))
+            {
+                logClientMutex_lock();
+                OS_LoggerConsumer_process(&client->consumer);
+                logClientMutex_unlock();
+                isEmpty = false;
+            }
+
+            uint32_t dropped = LogRing_getDropped(ring);
+            if (dropped != client->dropped)
+            {
+                printf("Log ring of %s dropped %u entries\n",
+                       client->name, (unsigned int)(dropped - client->dropped));
+                client->dropped = dropped;
+            }
+        }
     }
+    while (!isEmpty);
+}
 
-    return sec;
+// Store the events of all trace rings in the log, in records of up to
+// TRACE_EVENTS_PER_RECORD events. Called by the control thread, errors are
+// printed and not logged.
+static void
+drain_trace_rings(
+    uint64_t timeMs)
+{
+    for (size_t i = 0; i < NUM_TRACE_CLIENTS; i++)
+    {
+        TraceClient_t* client = &trace_clients[i];
+        Trace_Ring_t* ring = *client->port;
+
+        LogClient_t* logClient = (client->id <= LOG_CLIENTS_MAX_ID) ?
+                                 log_clients_by_id[client->id] : NULL;
+        if (NULL == logClient)
+        {
+            continue;
+        }
+
+        size_t numEvents;
+        do
+        {
+            numEvents = 0;
+            while ((numEvents < TRACE_EVENTS_PER_RECORD)
+                   && Trace_pop(ring, &trace_events[numEvents]))
+            {
+                numEvents++;
+            }
+
+            if (numEvents > 0)
+            {
+                OS_Error_t err = BinaryLogFormat_writeTrace(
+                                     (uint8_t)client->id,
+                                     logClient->name,
+                                     timeMs,
+                                     trace_events,
+                                     numEvents * sizeof(Trace_Event_t));
+                if (err != OS_SUCCESS)
+                {
+                    printf("Storing trace events of %s failed with %d\n",
+                           logClient->name, err);
+                    break;
+                }
+            }
+        }
+        while (TRACE_EVENTS_PER_RECORD == numEvents);
+
+        uint32_t dropped = Trace_getDropped(ring);
+        if (dropped != client->dropped)
+        {
+            printf("Trace ring of %s dropped %u events\n",
+                   logClient->name, (unsigned int)(dropped - client->dropped));
+            client->dropped = dropped;
+        }
+    }
+}
+
+// The entries of the LogServer itself do not come by RPC.
+static void
+emit_log_server(void)
+{
+    OS_LoggerConsumer_process(&log_consumer_log_server);
+}
+
+//------------------------------------------------------------------------------
+static void
+init_log_clients(void)
+{
+    for (size_t i = 0; i < NUM_LOG_CLIENTS; i++)
+    {
+        LogClient_t* client = &log_clients[i];
+
+        if ((client->id > LOG_CLIENTS_MAX_ID)
+            || (log_clients_by_id[client->id] != NULL))
+        {
+            printf("Log client %s has an invalid id %u\n",
+                   client->name, (unsigned int)client->id);
+            continue;
+        }
+
+        OS_LoggerFilter_ctor(&client->filter, client->level);
+        if (client->isRing)
+        {
+            LogRing_setLevel(*client->port, client->level);
+        }
+
+        OS_LoggerConsumer_ctor(
+            &client->consumer,
+            client->isRing ? (void*)ring_entry : *client->port,
+            &client->filter,
+            &log_consumer_callback,
+            &subject,
+            &log_file,
+            client->id,
+            client->name);
+
+        log_clients_by_id[client->id] = client;
+    }
 }
 
 // Public functions ------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// The emit RPC of the clients without a log ring. The client is found by the
+// badge of the call, so the cost does not depend on the number of clients.
+void
+API_LOG_SERVER_EMIT(void)
+{
+    uint32_t id = API_LOG_SERVER_GET_SENDER_ID();
+
+    LogClient_t* client = (id <= LOG_CLIENTS_MAX_ID) ?
+                          log_clients_by_id[id] : NULL;
+    if ((NULL == client) || client->isRing)
+    {
+        printf("Log entry of unknown client %u dropped\n", (unsigned int)id);
+        return;
+    }
+
+    logClientMutex_lock();
+    OS_LoggerConsumer_process(&client->consumer);
+    logClientMutex_unlock();
+}
+
+//------------------------------------------------------------------------------
+// Set the level of a client at runtime. The filter is constructed again with
+// the new level, which the consumers must not read meanwhile. Like in run(),
+// errors are printed and not logged.
+OS_Error_t
+logServerCtrl_rpc_setLevel(
+    unsigned int    clientId,
+    unsigned int    level)
+{
+    LogClient_t* client = (clientId <= LOG_CLIENTS_MAX_ID) ?
+                          log_clients_by_id[clientId] : NULL;
+    if (NULL == client)
+    {
+        printf("Log level for unknown client %u\n", clientId);
+        return OS_ERROR_NOT_FOUND;
+    }
+
+    if (level > Debug_LOG_LEVEL_TRACE)
+    {
+        printf("Invalid log level %u for %s\n", level, client->name);
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    logClientMutex_lock();
+
+    if (level == client->level)
+    {
+        logClientMutex_unlock();
+        return OS_SUCCESS;
+    }
+
+    client->level = level;
+    OS_LoggerFilter_ctor(&client->filter, client->level);
+
+    logClientMutex_unlock();
+
+    // the emitter of the client takes it over with its next entry, so entries
+    // below the level are not formatted anymore
+    if (client->isRing)
+    {
+        LogRing_setLevel(*client->port, level);
+    }
+
+    printf("Log level of %s set to %u\n", client->name, level);
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+
 void pre_init(void)
 {
     // create filesystem
@@ -144,31 +424,35 @@ void pre_init(void)
         return;
     }
 
-    // set up consumer chain
-    OS_LoggerConsumerChain_getInstance();
-
     // register objects to observe
     OS_LoggerSubject_ctor(&subject);
     // Emitter configuration
     OS_LoggerSubject_ctor(&subject_log_server);
 
-    // set up log file
-    OS_LoggerFile_ctor(&log_file, hFs, LOG_FILENAME);
+    // set up log file, it is kept on the segment that is written. The index
+    // that names the segment is accessed by the binary format under its own
+    // name.
+    if (BinaryLogFormat_init(hFs, LOG_FILE_PREFIX, &log_file, get_time_ms)
+        != OS_SUCCESS)
+    {
+        printf("Fail to init binary log file!\n");
+    }
 
-    // set up backend
-    OS_LoggerOutputFileSystem_ctor(&filesystem, &custom_log_format);
-    OS_LoggerOutputConsole_ctor(&console, &custom_log_format);
+    // set up backend, the console output passes every entry to its format.
+    // The dedup stage hands the entries that pass on to the binary format,
+    // which appends them to the log file, and to the text format.
+    if (LogDedup_init(log_formats, NUM_LOG_FORMATS) != OS_SUCCESS)
+    {
+        printf("Fail to init log dedup!\n");
+    }
+    OS_LoggerOutputConsole_ctor(&dedup, &log_dedup_format);
     // Emitter configuration
     OS_LoggerOutputConsole_ctor(&console_log_server, &custom_log_format);
 
     // attach observed object to subject
     OS_LoggerSubject_attach(
         (OS_LoggerAbstractSubject_Handle_t*)&subject,
-        &filesystem);
-
-    OS_LoggerSubject_attach(
-        (OS_LoggerAbstractSubject_Handle_t*)&subject,
-        &console);
+        &dedup);
 
     // Emitter configuration
     OS_LoggerSubject_attach(
@@ -176,11 +460,6 @@ void pre_init(void)
         &console_log_server);
 
     // set up log filter layer
-    OS_LoggerFilter_ctor(&filter_configSrv,      Debug_LOG_LEVEL_INFO);
-    OS_LoggerFilter_ctor(&filter_cloudCon,       Debug_LOG_LEVEL_INFO);
-    OS_LoggerFilter_ctor(&filter_sensorTemp,     Debug_LOG_LEVEL_INFO);
-    OS_LoggerFilter_ctor(&filter_nic,            Debug_LOG_LEVEL_INFO);
-    OS_LoggerFilter_ctor(&filter_nwStack,        Debug_LOG_LEVEL_INFO);
     // Emitter configuration
     OS_LoggerFilter_ctor(&filter_log_server,     Debug_LOG_LEVEL_INFO);
 
@@ -188,24 +467,10 @@ void pre_init(void)
     OS_LoggerConsumerCallback_ctor(
         &log_consumer_callback,
         API_LOG_SERVER_GET_SENDER_ID,
-        get_time_sec);
-
-    // set up log consumer layer
-    OS_LoggerConsumer_ctor(&log_consumer_configSrv,      DATABUFFER_SERVER_01,
-                           &filter_configSrv,      &log_consumer_callback, &subject, &log_file,
-                           CLIENT_CONFIGSRV_ID, "CONFIG-SERVER");
-    OS_LoggerConsumer_ctor(&log_consumer_cloudCon,       DATABUFFER_SERVER_02,
-                           &filter_cloudCon,       &log_consumer_callback, &subject, &log_file,
-                           CLIENT_CLOUDCON_ID, "CLOUDCONNECTOR");
-    OS_LoggerConsumer_ctor(&log_consumer_sensorTemp,     DATABUFFER_SERVER_03,
-                           &filter_sensorTemp,     &log_consumer_callback, &subject, &log_file,
-                           CLIENT_SENSORTEMP_ID, "SENSOR-TEMP");
-    OS_LoggerConsumer_ctor(&log_consumer_nic,       DATABUFFER_SERVER_04,
-                           &filter_nic,       &log_consumer_callback, &subject, &log_file,
-                           CLIENT_NIC_ID, "NIC");
-    OS_LoggerConsumer_ctor(&log_consumer_nwStack,        DATABUFFER_SERVER_05,
-                           &filter_nwStack,        &log_consumer_callback, &subject, &log_file,
-                           CLIENT_NWSTACK_ID, "NWSTACK");
+        get_time_ms);
+
+    // set up log consumer layer, the clients are found by their id
+    init_log_clients();
 
     // Emitter configuration
     OS_LoggerConsumer_ctor(&log_consumer_log_server, buf_log_server,
@@ -216,17 +481,56 @@ void pre_init(void)
     OS_LoggerEmitter_getInstance(
         buf_log_server,
         &filter_log_server,
-        API_LOG_SERVER_EMIT);
-
-    // set up consumer chain layer
-    OS_LoggerConsumerChain_append(&log_consumer_configSrv);
-    OS_LoggerConsumerChain_append(&log_consumer_cloudCon);
-    OS_LoggerConsumerChain_append(&log_consumer_sensorTemp);
-    OS_LoggerConsumerChain_append(&log_consumer_nic);
-    OS_LoggerConsumerChain_append(&log_consumer_nwStack);
-    // Emitter configuration
-    OS_LoggerConsumerChain_append(&log_consumer_log_server);
+        emit_log_server);
+
+    // the log segments have been set up by BinaryLogFormat_init(), the records
+    // of previous boots are kept
+
+    // the clients may have notified already, that is not lost
+    int ret = logRing_notify_reg_callback(drain_log_rings, NULL);
+    if (0 != ret)
+    {
+        printf("logRing_notify_reg_callback() failed with %d\n", ret);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Flush the repeat counts, the trace events and the buffered log records
+// periodically. Errors are printed and not logged, as logging from this thread
+// would run concurrently to the RPC.
+int run(void)
+{
+    // the local timer ID 0 is used for the sleep() function of the TimeServer
+    int ret = timeServer_rpc_periodic(1, NS_IN_MS * LOGSERVER_FLUSH_INTERVAL_MS);
+    if (0 != ret)
+    {
+        printf("timeServer_rpc_periodic() failed with %d\n", ret);
+        return -1;
+    }
+
+    for (;;)
+    {
+        timeServer_notify_wait();
+
+        uint64_t ms;
+        OS_Error_t err = TimeServer_getTime(&timer, TimeServer_PRECISION_MSEC,
+                                            &ms);
+        if (err != OS_SUCCESS)
+        {
+            printf("TimeServer_getTime() failed with %d\n", err);
+        }
+        else
+        {
+            LogDedup_flush(ms);
+            drain_trace_rings(ms);
+        }
+
+        err = BinaryLogFormat_flush();
+        if ((err != OS_SUCCESS) && (err != OS_ERROR_INVALID_STATE))
+        {
+            printf("BinaryLogFormat_flush() failed with %d\n", err);
+        }
+    }
 
-    // create log file
-    OS_LoggerFile_create(&log_file);
+    return 0;
 }
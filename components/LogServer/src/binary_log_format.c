@@ -0,0 +1,808 @@
+/*
+ * Binary log record format for the log file.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "binary_log_format.h"
+
+#include "lib_debug/Debug.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <camkes.h>
+
+/* Defines -------------------------------------------------------------------*/
+// a NAME record may precede the MESSAGE record of an entry
+#define MAX_RECORDS_SIZE                                                      \
+    ((2 * BinaryLogFormat_HEADER_SIZE) + OS_Logger_NAME_LENGTH                \
+     + OS_Logger_ENTRY_MESSAGE_LENGTH)
+
+#define MAX_CLIENT_IDS  256
+
+#define SECTOR_SIZE     512
+
+#define INDEX_MAGIC     "TLIX"
+#define INDEX_VERSION   1
+#define INDEX_SIZE      24
+
+#define MAX_FILE_NAME   16
+
+_Static_assert((LOGSERVER_WRITE_BUFFER_SIZE % SECTOR_SIZE) == 0,
+               "the write buffer must hold whole sectors");
+_Static_assert((LOGSERVER_SEGMENT_SIZE % LOGSERVER_WRITE_BUFFER_SIZE) == 0,
+               "a segment must hold whole write buffers");
+_Static_assert(LOGSERVER_SEGMENT_SIZE
+               >= (BinaryLogFormat_SEGMENT_HEADER_SIZE + 2 * MAX_RECORDS_SIZE),
+               "a segment must hold at least one entry");
+_Static_assert(LOGSERVER_NUM_SEGMENTS <= 100,
+               "the segment number must fit into the file name");
+
+/* Private functions prototypes ----------------------------------------------*/
+static OS_Error_t
+_Log_format_convert(
+    OS_LoggerAbstractFormat_Handle_t* self,
+    OS_LoggerEntry_t const* const entry);
+
+static OS_Error_t
+_Log_format_print(
+    OS_LoggerAbstractFormat_Handle_t* self);
+
+/* Instance variables --------------------------------------------------------*/
+static const OS_LoggerAbstractFormat_vtable_t _binary_log_format_vtable =
+{
+    .convert = _Log_format_convert,
+    .print   = _Log_format_print
+};
+
+OS_LoggerFormat_Handle_t binary_log_format =
+{
+    .vtable = &_binary_log_format_vtable
+};
+
+static const uint8_t zeroSector[SECTOR_SIZE];
+
+// convert() keeps the entry and print() turns it into records, so it can start
+// a new segment first if they do not fit. The entry stays valid until print()
+// has been called. Entries are printed by more than one thread of the
+// LogServer, so logFileMutex is held from convert() to print() and one record
+// buffer is enough.
+//
+// The write buffer maps the part of the segment from a sector aligned offset
+// on, so every write starts at a sector boundary. A flush writes the sectors
+// with new data including the zeros behind the last record, which mark the end
+// of the records in the segment. The buffer moves on once it is full.
+static struct
+{
+    OS_FileSystem_Handle_t  hFs;
+    const char*             prefix;
+    char                    indexName[MAX_FILE_NAME];
+    char                    segmentName[MAX_FILE_NAME];
+    OS_LoggerFile_Handle_t* logFile;
+    uint32_t                segment;
+    uint32_t                sequence;
+    bool                    isReady;
+
+    OS_LoggerEntry_t const* entry;
+    struct
+    {
+        uint8_t             id;
+        const char*         name;
+        uint64_t            timeMs;
+        const void*         events;
+        size_t              size;
+    } trace;
+    uint32_t                knownIds[MAX_CLIENT_IDS / 32];
+    size_t                  size;
+    uint8_t                 records[MAX_RECORDS_SIZE];
+
+    struct
+    {
+        off_t               offset;
+        size_t              used;
+        size_t              written;
+        uint8_t             data[LOGSERVER_WRITE_BUFFER_SIZE];
+    } buffer;
+} binaryLog;
+
+// Private functions -----------------------------------------------------------
+
+//------------------------------------------------------------------------------
+static
+uint8_t*
+putLe(
+    uint8_t*    dst,
+    uint64_t    value,
+    size_t      size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        dst[i] = (uint8_t)(value >> (8 * i));
+    }
+
+    return dst + size;
+}
+
+//------------------------------------------------------------------------------
+static
+uint32_t
+getLe32(
+    const uint8_t* src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8)
+           | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+//------------------------------------------------------------------------------
+static
+void
+addRecord(
+    BinaryLogFormat_Type_t  type,
+    uint8_t                 id,
+    uint8_t                 levels,
+    uint64_t                timeMs,
+    const void*             payload,
+    size_t                  length)
+{
+    uint8_t* dst = &binaryLog.records[binaryLog.size];
+
+    *dst++ = BinaryLogFormat_SYNC;
+    *dst++ = (uint8_t)type;
+    *dst++ = id;
+    *dst++ = levels;
+    dst = putLe(dst, length, 2);
+    dst = putLe(dst, timeMs, 8);
+    if (length > 0)
+    {
+        memcpy(dst, payload, length);
+    }
+
+    binaryLog.size += BinaryLogFormat_HEADER_SIZE + length;
+}
+
+//------------------------------------------------------------------------------
+// Start the records with a NAME record if the id has not been used in the
+// segment yet. The host only gets the id with every record, so it has to
+// learn the name once per segment.
+static
+void
+startRecords(
+    uint8_t     id,
+    const char* name,
+    uint64_t    timeMs)
+{
+    binaryLog.size = 0;
+
+    uint32_t idBit = 1U << (id % 32);
+    if (!(binaryLog.knownIds[id / 32] & idBit))
+    {
+        addRecord(BinaryLogFormat_TYPE_NAME, id, 0, timeMs,
+                  name, strnlen(name, OS_Logger_NAME_LENGTH));
+        binaryLog.knownIds[id / 32] |= idBit;
+    }
+}
+
+//------------------------------------------------------------------------------
+static
+void
+buildRecords(void)
+{
+    OS_LoggerEntry_t const* const entry = binaryLog.entry;
+
+    uint8_t id = (uint8_t)entry->consumerMetadata.id;
+    uint8_t levels = (uint8_t)(((entry->emitterMetadata.filteringLevel & 0xF) << 4)
+                               | (entry->consumerMetadata.filteringLevel & 0xF));
+    uint64_t timeMs = entry->consumerMetadata.timestamp;
+
+    startRecords(id, entry->consumerMetadata.name, timeMs);
+
+    addRecord(BinaryLogFormat_TYPE_MESSAGE, id, levels, timeMs,
+              entry->msg, strnlen(entry->msg, OS_Logger_ENTRY_MESSAGE_LENGTH));
+}
+
+//------------------------------------------------------------------------------
+static
+void
+buildTraceRecords(void)
+{
+    startRecords(binaryLog.trace.id, binaryLog.trace.name,
+                 binaryLog.trace.timeMs);
+
+    addRecord(BinaryLogFormat_TYPE_TRACE, binaryLog.trace.id, 0,
+              binaryLog.trace.timeMs, binaryLog.trace.events,
+              binaryLog.trace.size);
+}
+
+//------------------------------------------------------------------------------
+// Errors are printed and not logged, as this runs as part of the logging.
+static
+OS_Error_t
+accessFile(
+    const char* name,
+    off_t       offset,
+    void*       data,
+    size_t      size,
+    bool        isWrite)
+{
+    OS_FileSystemFile_Handle_t hFile;
+
+    OS_Error_t err = OS_FileSystemFile_open(
+                         binaryLog.hFs,
+                         &hFile,
+                         name,
+                         OS_FileSystem_OpenMode_RDWR,
+                         OS_FileSystem_OpenFlags_CREATE);
+    if (err != OS_SUCCESS)
+    {
+        printf("OS_FileSystemFile_open() for %s failed with %d\n", name, err);
+        return err;
+    }
+
+    err = isWrite ?
+          OS_FileSystemFile_write(binaryLog.hFs, hFile, offset, size, data) :
+          OS_FileSystemFile_read(binaryLog.hFs, hFile, offset, size, data);
+    OS_FileSystemFile_close(binaryLog.hFs, hFile);
+    if (err != OS_SUCCESS)
+    {
+        printf("Accessing %zu bytes at %lld of %s failed with %d\n",
+               size, (long long)offset, name, err);
+        return err;
+    }
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+void
+resetBuffer(
+    off_t offset)
+{
+    binaryLog.buffer.offset = offset;
+    binaryLog.buffer.used = 0;
+    binaryLog.buffer.written = 0;
+
+    // the zeros behind the records are written as the end marker
+    memset(binaryLog.buffer.data, 0, sizeof(binaryLog.buffer.data));
+}
+
+//------------------------------------------------------------------------------
+// Write the sectors of the buffer that have new data, including the zeros up
+// to the end of the sector of the last record. A full buffer is released, even
+// if it could not be written, so logging goes on.
+static
+OS_Error_t
+flushBuffer(void)
+{
+    OS_Error_t err = OS_SUCCESS;
+
+    if (binaryLog.buffer.used > binaryLog.buffer.written)
+    {
+        size_t start = binaryLog.buffer.written
+                       - (binaryLog.buffer.written % SECTOR_SIZE);
+        // a record that ends at a sector boundary is followed by a sector of
+        // zeros, otherwise data of the previous use of the segment follows
+        size_t end = (binaryLog.buffer.used / SECTOR_SIZE + 1) * SECTOR_SIZE;
+        end = (end > sizeof(binaryLog.buffer.data)) ?
+              sizeof(binaryLog.buffer.data) : end;
+
+        err = accessFile(binaryLog.segmentName,
+                         binaryLog.buffer.offset + start,
+                         &binaryLog.buffer.data[start],
+                         end - start,
+                         true);
+        if (OS_SUCCESS == err)
+        {
+            binaryLog.buffer.written = binaryLog.buffer.used;
+        }
+    }
+
+    if (binaryLog.buffer.used == sizeof(binaryLog.buffer.data))
+    {
+        resetBuffer(binaryLog.buffer.offset + binaryLog.buffer.used);
+
+        // the end marker for a buffer that ended with a record
+        if ((OS_SUCCESS == err)
+            && (binaryLog.buffer.offset < LOGSERVER_SEGMENT_SIZE))
+        {
+            err = accessFile(binaryLog.segmentName,
+                             binaryLog.buffer.offset,
+                             (void*)zeroSector,
+                             sizeof(zeroSector),
+                             true);
+        }
+    }
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+appendToBuffer(
+    const void* data,
+    size_t      size)
+{
+    const uint8_t* src = data;
+    OS_Error_t err = OS_SUCCESS;
+
+    while (size > 0)
+    {
+        size_t len = sizeof(binaryLog.buffer.data) - binaryLog.buffer.used;
+        len = (size < len) ? size : len;
+
+        memcpy(&binaryLog.buffer.data[binaryLog.buffer.used], src, len);
+        binaryLog.buffer.used += len;
+        src += len;
+        size -= len;
+
+        if (binaryLog.buffer.used == sizeof(binaryLog.buffer.data))
+        {
+            OS_Error_t ret = flushBuffer();
+            err = (OS_SUCCESS == err) ? ret : err;
+        }
+    }
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+static
+size_t
+getSegmentSpace(void)
+{
+    return LOGSERVER_SEGMENT_SIZE
+           - (binaryLog.buffer.offset + binaryLog.buffer.used);
+}
+
+//------------------------------------------------------------------------------
+static
+void
+setSegmentName(void)
+{
+    snprintf(binaryLog.segmentName, sizeof(binaryLog.segmentName),
+             "%s%02u.bin", binaryLog.prefix, (unsigned int)binaryLog.segment);
+
+    // the log file of the consumers follows the segment that is written
+    OS_LoggerFile_ctor(binaryLog.logFile, binaryLog.hFs, binaryLog.segmentName);
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+writeIndex(void)
+{
+    uint8_t index[INDEX_SIZE];
+    uint8_t* dst = index;
+
+    memcpy(dst, INDEX_MAGIC, 4);
+    dst = putLe(dst + 4, INDEX_VERSION, 4);
+    dst = putLe(dst, LOGSERVER_NUM_SEGMENTS, 4);
+    dst = putLe(dst, LOGSERVER_SEGMENT_SIZE, 4);
+    dst = putLe(dst, binaryLog.segment, 4);
+    putLe(dst, binaryLog.sequence, 4);
+
+    return accessFile(binaryLog.indexName, 0, index, sizeof(index), true);
+}
+
+//------------------------------------------------------------------------------
+// Get the current segment from the index. An index written for another number
+// or size of segments is not used.
+static
+bool
+readIndex(void)
+{
+    uint8_t index[INDEX_SIZE];
+
+    off_t size;
+    if ((OS_FileSystemFile_getSize(binaryLog.hFs, binaryLog.indexName, &size)
+         != OS_SUCCESS) || (size < sizeof(index)))
+    {
+        return false;
+    }
+
+    if ((accessFile(binaryLog.indexName, 0, index, sizeof(index), false)
+         != OS_SUCCESS)
+        || (memcmp(index, INDEX_MAGIC, 4) != 0)
+        || (getLe32(&index[4]) != INDEX_VERSION)
+        || (getLe32(&index[8]) != LOGSERVER_NUM_SEGMENTS)
+        || (getLe32(&index[12]) != LOGSERVER_SEGMENT_SIZE)
+        || (getLe32(&index[16]) >= LOGSERVER_NUM_SEGMENTS))
+    {
+        return false;
+    }
+
+    binaryLog.segment = getLe32(&index[16]);
+    binaryLog.sequence = getLe32(&index[20]);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Allocate all clusters of a segment when it is used for the first time, so
+// appending never has to extend the file. Writing the last sector lets the
+// file system allocate the rest.
+static
+OS_Error_t
+preallocateSegment(void)
+{
+    off_t size;
+
+    if ((OS_FileSystemFile_getSize(binaryLog.hFs, binaryLog.segmentName, &size)
+         == OS_SUCCESS) && (size >= LOGSERVER_SEGMENT_SIZE))
+    {
+        return OS_SUCCESS;
+    }
+
+    return accessFile(binaryLog.segmentName,
+                      LOGSERVER_SEGMENT_SIZE - SECTOR_SIZE,
+                      (void*)zeroSector,
+                      sizeof(zeroSector),
+                      true);
+}
+
+//------------------------------------------------------------------------------
+// Continue in the given segment of the ring with the next sequence number, the
+// records of its previous use are dropped.
+static
+OS_Error_t
+startSegment(
+    uint32_t segment)
+{
+    binaryLog.segment = segment % LOGSERVER_NUM_SEGMENTS;
+    binaryLog.sequence++;
+    setSegmentName();
+
+    memset(binaryLog.knownIds, 0, sizeof(binaryLog.knownIds));
+
+    OS_Error_t err = preallocateSegment();
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    uint8_t header[BinaryLogFormat_SEGMENT_HEADER_SIZE];
+    uint8_t* dst = header;
+
+    memcpy(dst, BinaryLogFormat_MAGIC, 4);
+    dst = putLe(dst + 4, BinaryLogFormat_VERSION, 4);
+    dst = putLe(dst, binaryLog.sequence, 4);
+    putLe(dst, LOGSERVER_SEGMENT_SIZE, 4);
+
+    resetBuffer(0);
+    appendToBuffer(header, sizeof(header));
+
+    // the segment has to end after the header before the index points to it
+    err = flushBuffer();
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    return writeIndex();
+}
+
+//------------------------------------------------------------------------------
+// Find the end of the records in the current segment. It is read in chunks of
+// the size of the write buffer, a record that does not fit into a chunk is
+// read again with the next one.
+static
+OS_Error_t
+findSegmentEnd(
+    off_t* end)
+{
+    uint8_t* chunk = binaryLog.buffer.data;
+
+    OS_Error_t err = accessFile(binaryLog.segmentName, 0, chunk,
+                                BinaryLogFormat_SEGMENT_HEADER_SIZE, false);
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    if ((memcmp(chunk, BinaryLogFormat_MAGIC, 4) != 0)
+        || (getLe32(&chunk[4]) != BinaryLogFormat_VERSION)
+        || (getLe32(&chunk[8]) != binaryLog.sequence))
+    {
+        printf("Log segment %s does not match the index\n",
+               binaryLog.segmentName);
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    off_t pos = BinaryLogFormat_SEGMENT_HEADER_SIZE;
+    for (;;)
+    {
+        size_t len = LOGSERVER_SEGMENT_SIZE - pos;
+        len = (len > sizeof(binaryLog.buffer.data)) ?
+              sizeof(binaryLog.buffer.data) : len;
+        if (len < BinaryLogFormat_HEADER_SIZE)
+        {
+            break;
+        }
+
+        err = accessFile(binaryLog.segmentName, pos, chunk, len, false);
+        if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+
+        size_t i = 0;
+        while ((i + BinaryLogFormat_HEADER_SIZE) <= len)
+        {
+            const uint8_t* record = &chunk[i];
+
+            if ((record[0] != BinaryLogFormat_SYNC)
+                || (record[1] < BinaryLogFormat_TYPE_MESSAGE)
+                || (record[1] > BinaryLogFormat_TYPE_TRACE))
+            {
+                *end = pos + i;
+                return OS_SUCCESS;
+            }
+
+            size_t recordSize = BinaryLogFormat_HEADER_SIZE
+                                + (record[4] | (record[5] << 8));
+            if ((i + recordSize) > len)
+            {
+                break;
+            }
+            i += recordSize;
+        }
+
+        if (0 == i)
+        {
+            // a record beyond the end of the segment
+            break;
+        }
+        pos += i;
+    }
+
+    *end = pos;
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// Continue after the last record of the segment of the index, the write buffer
+// is filled with the records before it.
+static
+OS_Error_t
+resumeSegment(void)
+{
+    setSegmentName();
+
+    OS_Error_t err = preallocateSegment();
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    off_t end;
+    err = findSegmentEnd(&end);
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    // the buffer stays aligned to its size, so it never crosses the end of the
+    // segment
+    size_t size = end % LOGSERVER_WRITE_BUFFER_SIZE;
+    resetBuffer(end - size);
+
+    if (size > 0)
+    {
+        err = accessFile(binaryLog.segmentName,
+                         binaryLog.buffer.offset,
+                         binaryLog.buffer.data,
+                         size,
+                         false);
+        if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+    }
+
+    binaryLog.buffer.used = size;
+    binaryLog.buffer.written = size;
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// Build the records and append them to the segment, or to the next one if they
+// do not fit. build() is called again for the next segment, so it starts with
+// the NAME record.
+static
+OS_Error_t
+writeRecords(
+    void (*build)(void))
+{
+    OS_Error_t err = OS_SUCCESS;
+
+    build();
+    if (binaryLog.size > getSegmentSpace())
+    {
+        flushBuffer();
+
+        err = startSegment(binaryLog.segment + 1);
+        if (err != OS_SUCCESS)
+        {
+            printf("Starting log segment %s failed with %d\n",
+                   binaryLog.segmentName, err);
+            return err;
+        }
+
+        build();
+    }
+
+    return appendToBuffer(binaryLog.records, binaryLog.size);
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+_Log_format_convert(
+    OS_LoggerAbstractFormat_Handle_t* self,
+    OS_LoggerEntry_t const* const entry)
+{
+    OS_Logger_CHECK_SELF(self);
+
+    // the output calls print() right after convert(), which releases the lock
+    logFileMutex_lock();
+
+    binaryLog.entry = entry;
+
+    return (NULL == entry) ? OS_ERROR_INVALID_PARAMETER : OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+_Log_format_print(
+    OS_LoggerAbstractFormat_Handle_t* self)
+{
+    OS_Logger_CHECK_SELF(self);
+
+    OS_LoggerEntry_t const* const entry = binaryLog.entry;
+
+    if (!binaryLog.isReady || (NULL == entry))
+    {
+        logFileMutex_unlock();
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    OS_Error_t err = writeRecords(buildRecords);
+    binaryLog.entry = NULL;
+
+    // errors must not get lost if the system goes down right after them
+    if ((OS_SUCCESS == err)
+        && (entry->emitterMetadata.filteringLevel <= Debug_LOG_LEVEL_ERROR))
+    {
+        err = flushBuffer();
+    }
+
+    logFileMutex_unlock();
+
+    return err;
+}
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+OS_Error_t
+BinaryLogFormat_init(
+    OS_FileSystem_Handle_t  hFs,
+    const char*             prefix,
+    OS_LoggerFile_Handle_t* logFile,
+    uint64_t                (*getTimeMs)(void))
+{
+    if ((NULL == prefix) || (NULL == logFile) || (NULL == getTimeMs)
+        || (strlen(prefix) >= (MAX_FILE_NAME - sizeof("00.bin"))))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    binaryLog.hFs = hFs;
+    binaryLog.prefix = prefix;
+    binaryLog.logFile = logFile;
+    snprintf(binaryLog.indexName, sizeof(binaryLog.indexName),
+             "%s.idx", prefix);
+
+    // the records of previous boots are kept, new ones are appended to the
+    // segment of the index
+    OS_Error_t err;
+    if (readIndex())
+    {
+        err = resumeSegment();
+        if (err != OS_SUCCESS)
+        {
+            err = startSegment(binaryLog.segment + 1);
+        }
+    }
+    else
+    {
+        binaryLog.sequence = 0;
+        err = startSegment(0);
+    }
+
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    binaryLog.size = 0;
+    addRecord(BinaryLogFormat_TYPE_BOOT, 0, 0, getTimeMs(), NULL, 0);
+    if (binaryLog.size > getSegmentSpace())
+    {
+        err = startSegment(binaryLog.segment + 1);
+        if (err != OS_SUCCESS)
+        {
+            return err;
+        }
+    }
+    appendToBuffer(binaryLog.records, binaryLog.size);
+
+    err = flushBuffer();
+    if (err != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    binaryLog.isReady = true;
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+BinaryLogFormat_writeTrace(
+    uint8_t     id,
+    const char* name,
+    uint64_t    timeMs,
+    const void* events,
+    size_t      size)
+{
+    if ((NULL == name) || (NULL == events) || (0 == size)
+        || (size > BinaryLogFormat_MAX_TRACE_SIZE))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (!binaryLog.isReady)
+    {
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    logFileMutex_lock();
+
+    binaryLog.trace.id = id;
+    binaryLog.trace.name = name;
+    binaryLog.trace.timeMs = timeMs;
+    binaryLog.trace.events = events;
+    binaryLog.trace.size = size;
+
+    OS_Error_t err = writeRecords(buildTraceRecords);
+
+    logFileMutex_unlock();
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+BinaryLogFormat_flush(void)
+{
+    if (!binaryLog.isReady)
+    {
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    logFileMutex_lock();
+    OS_Error_t err = flushBuffer();
+    logFileMutex_unlock();
+
+    return err;
+}
@@ -0,0 +1,108 @@
+/*
+ * Binary log record format for the log file.
+ *
+ * Instead of formatting every entry as text, the LogServer writes a compact
+ * binary record per entry to the log file and leaves the formatting to the
+ * host, see tools/log_decode.py. The console output stays text.
+ *
+ * The log is kept in a ring of LOGSERVER_NUM_SEGMENTS segment files of
+ * LOGSERVER_SEGMENT_SIZE each, "<prefix>00.bin" and so on. A segment is
+ * preallocated when it is used for the first time, so appending never has to
+ * extend the file, and the oldest segment is overwritten once the ring is
+ * full. The index file "<prefix>.idx" holds the current segment and its
+ * sequence number, it is only written when a segment is started.
+ *
+ * A segment starts with a header of the magic "TLOG", the 32-bit format
+ * version, the sequence number of the segment and the segment size, followed
+ * by the records. The records end at the first byte that is not
+ * BinaryLogFormat_SYNC, the LogServer writes zeros behind the last record.
+ * Every record has a header of 14 bytes, all values little endian:
+ *
+ *   sync       8 bit, BinaryLogFormat_SYNC
+ *   type       8 bit, BinaryLogFormat_Type_t
+ *   id         8 bit, log client id of the component
+ *   levels     8 bit, emitter level << 4 | consumer level
+ *   length     16 bit, size of the payload that follows
+ *   time       64 bit, monotonic time in ms
+ *
+ * The records are collected in a write buffer of LOGSERVER_WRITE_BUFFER_SIZE
+ * and written in whole sectors when it is full, by BinaryLogFormat_flush()
+ * and right away for entries of level ERROR and FATAL.
+ *
+ * A MESSAGE record carries the message without a terminating zero. A NAME
+ * record carries the name of the client id, it is written the first time an
+ * id shows up in a segment, so every segment can be decoded on its own. A
+ * BOOT record has no payload and marks the start of the LogServer, the time
+ * restarts from there. A TRACE record carries tracepoint events of the client
+ * as Trace_Event_t of include/util/trace.h, each with its own time in ns.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "Logger/Server/OS_LoggerFormat.h"
+#include "Logger/Server/OS_LoggerFile.h"
+
+#include "OS_FileSystem.h"
+
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define BinaryLogFormat_MAGIC           "TLOG"
+#define BinaryLogFormat_VERSION         2
+#define BinaryLogFormat_SEGMENT_HEADER_SIZE 16
+
+#define BinaryLogFormat_SYNC            0xA5
+#define BinaryLogFormat_HEADER_SIZE     14
+
+// the payload of a TRACE record fits into the space of a message
+#define BinaryLogFormat_MAX_TRACE_SIZE  OS_Logger_ENTRY_MESSAGE_LENGTH
+
+typedef enum
+{
+    BinaryLogFormat_TYPE_MESSAGE = 1,
+    BinaryLogFormat_TYPE_NAME,
+    BinaryLogFormat_TYPE_BOOT,
+    BinaryLogFormat_TYPE_TRACE,
+} BinaryLogFormat_Type_t;
+
+/* Public variables ----------------------------------------------------------*/
+// Attach it to an output that calls the print() of its format for every
+// entry, print() then appends the record to the log file.
+extern OS_LoggerFormat_Handle_t binary_log_format;
+
+/* Public functions ----------------------------------------------------------*/
+
+// Continue in the segment of the index with the given file name prefix, or
+// start a new ring if there is no valid index, and write a BOOT record.
+// logFile is set to the segment that is written and follows it to the next
+// one, the index is not accessed through it. A read_log_file() that overlaps
+// the switch to the next segment may fail and has to be repeated. getTimeMs
+// provides the time of the records.
+OS_Error_t
+BinaryLogFormat_init(
+    OS_FileSystem_Handle_t  hFs,
+    const char*             prefix,
+    OS_LoggerFile_Handle_t* logFile,
+    uint64_t                (*getTimeMs)(void));
+
+// Append a TRACE record with tracepoint events of the client id, name is the
+// name of the client. The events are stored as they are, up to
+// BinaryLogFormat_MAX_TRACE_SIZE bytes.
+OS_Error_t
+BinaryLogFormat_writeTrace(
+    uint8_t     id,
+    const char* name,
+    uint64_t    timeMs,
+    const void* events,
+    size_t      size);
+
+// Write the buffered records to the log file. It is called periodically, so
+// no record stays in RAM longer than LOGSERVER_FLUSH_INTERVAL_MS.
+OS_Error_t
+BinaryLogFormat_flush(void);
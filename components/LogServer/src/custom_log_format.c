@@ -8,15 +8,19 @@
 
 #include "custom_log_format.h"
 #include <stdio.h>
+#include <camkes.h>
 
 static OS_Error_t _Log_format_convert(
     OS_LoggerAbstractFormat_Handle_t* self,
     OS_LoggerEntry_t const* const entry);
 
+static OS_Error_t _Log_format_print(
+    OS_LoggerAbstractFormat_Handle_t* self);
+
 static const OS_LoggerAbstractFormat_vtable_t _custom_log_format_vtable =
 {
     .convert = _Log_format_convert,
-    .print   = OS_LoggerFormat_print
+    .print   = _Log_format_print
 };
 
 OS_LoggerFormat_Handle_t custom_log_format =
@@ -32,6 +36,11 @@ _Log_format_convert(
 {
     OS_Logger_CHECK_SELF(self);
 
+    // Entries are printed by more than one thread of the LogServer and the
+    // text is kept in the format until print(), which releases the lock. The
+    // output calls it right after convert().
+    consoleMutex_lock();
+
     if (NULL == entry)
     {
         return OS_ERROR_INVALID_PARAMETER;
@@ -40,7 +49,8 @@ _Log_format_convert(
     OS_LoggerTimestamp_Handle_t* const timestamp =
         OS_LoggerTimestamp_getInstance();
 
-    timestamp->timestamp = entry->consumerMetadata.timestamp;
+    // the entries are stamped in ms
+    timestamp->timestamp = entry->consumerMetadata.timestamp / 1000;
 
     OS_LoggerTime_Handle_t tm;
     OS_LoggerTimestamp_getTime(timestamp, 0, &tm);
@@ -71,3 +81,15 @@ _Log_format_convert(
 
     return OS_SUCCESS;
 }
+
+static
+OS_Error_t
+_Log_format_print(
+    OS_LoggerAbstractFormat_Handle_t* self)
+{
+    OS_Error_t err = OS_LoggerFormat_print(self);
+
+    consoleMutex_unlock();
+
+    return err;
+}
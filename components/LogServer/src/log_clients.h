@@ -0,0 +1,46 @@
+/*
+ * The log clients of the LogServer.
+ *
+ * Every line creates the filter and the consumer of a client in pre_init() and
+ * makes it reachable by its id, which is the badge of its emit RPC. A new
+ * client only needs a line here and its connections in the CAmkES assembly.
+ *
+ *   _X_(id, name, dataport, isRing, level)
+ *
+ * A client with isRing passes its entries in a ring in the dataport, see
+ * include/util/log_ring.h, the others call the emit RPC for every entry. level
+ * is the filter level of the client's entries until the ConfigServer sets the
+ * one from the Domain-Logging of configuration/config.xml.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+//------------------------------------------------------------------------------
+#define LOG_CLIENTS(_X_)                                                      \
+    _X_(CONFIGSERVER_LOGGER_ID,   "CONFIG-SERVER",  configServer_port,        \
+        true,  Debug_LOG_LEVEL_INFO)                                          \
+    _X_(CLOUDCONNECTOR_LOGGER_ID, "CLOUDCONNECTOR", cloudConnector_port,      \
+        true,  Debug_LOG_LEVEL_INFO)                                          \
+    _X_(SENSOR_LOGGER_ID,         "SENSOR-TEMP",    sensor_port,              \
+        true,  Debug_LOG_LEVEL_INFO)                                          \
+    _X_(NIC_LOGGER_ID,            "NIC",            nwDriver_port,            \
+        false, Debug_LOG_LEVEL_INFO)                                          \
+    _X_(NWSTACK_LOGGER_ID,        "NWSTACK",        nwStack_port,             \
+        false, Debug_LOG_LEVEL_INFO)
+
+// The log clients with tracepoints, see include/util/trace.h. The LogServer
+// stores the events of their trace dataports in the log.
+//
+//   _X_(id, dataport)
+#define TRACE_CLIENTS(_X_)                                                    \
+    _X_(CLOUDCONNECTOR_LOGGER_ID, cloudConnector_trace_port)                  \
+    _X_(SENSOR_LOGGER_ID,         sensor_trace_port)
+
+// The ids index the dispatch table, so they must stay below this.
+#define LOG_CLIENTS_MAX_ID          63
@@ -0,0 +1,499 @@
+/*
+ * Deduplication and rate limiting of the log entries.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "log_dedup.h"
+#include "log_clients.h"
+#include "boot_trace.h"
+
+#include "lib_debug/Debug.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <camkes.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define NUM_CLIENT_IDS  (LOG_CLIENTS_MAX_ID + 1)
+
+// the buckets count in thousandths of an entry, so a rate in entries per
+// second adds that many per ms
+#define TOKEN           1000
+
+// the start of a folded message that is quoted in its repeat count
+#define RECENT_TEXT_SIZE    48
+
+// The CloudConnector writes the boot trace, one line per phase of each
+// component. Only that many of its lines are exempt from the rate limit.
+#define BOOT_TRACE_CLIENT_ID    CLOUDCONNECTOR_LOGGER_ID
+#define BOOT_TRACE_MAX_LINES    (BootTrace_MAX_COMPONENTS * BootTrace_MAX_PHASES)
+
+typedef enum
+{
+    BUCKET_ERROR,       // ASSERT, FATAL and ERROR
+    BUCKET_WARNING,
+    BUCKET_INFO,
+    BUCKET_DEBUG,       // DEBUG and TRACE
+    NUM_BUCKETS
+} LogDedup_Bucket_t;
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+    bool        isStarted;
+    uint32_t    tokens;
+    uint64_t    lastMs;
+    uint32_t    suppressed;
+    uint8_t     suppressedLevel;
+} LogDedup_TokenBucket_t;
+
+// A message a client has passed on recently. Only the hash of the level and
+// the message is compared, a slot with a hash of 0 is free.
+typedef struct
+{
+    uint64_t    hash;
+    uint8_t     level;
+    uint32_t    repeats;
+    uint64_t    lastSeenMs;
+    uint64_t    firstRepeatMs;
+    uint64_t    lastRepeatMs;
+    char        text[RECENT_TEXT_SIZE];
+} LogDedup_Recent_t;
+
+typedef struct
+{
+    bool                    hasLast;
+    OS_LoggerEntry_t        last;       // the last entry that was passed on
+    LogDedup_Recent_t       recent[LOGSERVER_DEDUP_WINDOW];
+    uint32_t                bootTraceLines;
+    LogDedup_TokenBucket_t  buckets[NUM_BUCKETS];
+} LogDedup_Client_t;
+
+/* Private functions prototypes ----------------------------------------------*/
+static OS_Error_t
+_Log_format_convert(
+    OS_LoggerAbstractFormat_Handle_t* self,
+    OS_LoggerEntry_t const* const entry);
+
+static OS_Error_t
+_Log_format_print(
+    OS_LoggerAbstractFormat_Handle_t* self);
+
+/* Instance variables --------------------------------------------------------*/
+static const OS_LoggerAbstractFormat_vtable_t _log_dedup_format_vtable =
+{
+    .convert = _Log_format_convert,
+    .print   = _Log_format_print
+};
+
+OS_LoggerFormat_Handle_t log_dedup_format =
+{
+    .vtable = &_log_dedup_format_vtable
+};
+
+// in entries per second, 0 is no limit
+static const uint32_t rateLimits[NUM_BUCKETS] =
+{
+    [BUCKET_ERROR]      = LOGSERVER_RATE_LIMIT_ERROR,
+    [BUCKET_WARNING]    = LOGSERVER_RATE_LIMIT_WARNING,
+    [BUCKET_INFO]       = LOGSERVER_RATE_LIMIT_INFO,
+    [BUCKET_DEBUG]      = LOGSERVER_RATE_LIMIT_DEBUG,
+};
+
+// convert() hands the entry on right away and print() does nothing, so there
+// is no state between them. Entries are processed by more than one thread of
+// the LogServer and repeats are also written by LogDedup_flush(), so
+// logDedupMutex is held while the state of the clients is used. It is taken
+// before the locks of the formats.
+static struct
+{
+    OS_LoggerAbstractFormat_Handle_t* const*    formats;
+    size_t                                      numFormats;
+    LogDedup_Client_t                           clients[NUM_CLIENT_IDS];
+    OS_LoggerEntry_t                            note;
+} logDedup;
+
+// Private functions -----------------------------------------------------------
+
+//------------------------------------------------------------------------------
+static void
+forward(
+    OS_LoggerEntry_t const* const entry)
+{
+    for (size_t i = 0; i < logDedup.numFormats; i++)
+    {
+        OS_LoggerAbstractFormat_Handle_t* format = logDedup.formats[i];
+
+        // print() releases the lock convert() has taken, so it is called even
+        // if convert() fails, and it reports the error itself
+        format->vtable->convert(format, entry);
+        format->vtable->print(format);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Hand on an entry of the LogServer about the entries of a client, with the
+// id and name of template.
+static void
+forwardNote(
+    OS_LoggerEntry_t const* const   template,
+    uint8_t                         level,
+    uint64_t                        timeMs,
+    const char*                     format,
+    ...)
+{
+    OS_LoggerEntry_t* note = &logDedup.note;
+
+    memcpy(note, template, sizeof(*note));
+    note->consumerMetadata.timestamp = timeMs;
+    note->emitterMetadata.filteringLevel = level;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(note->msg, sizeof(note->msg), format, args);
+    va_end(args);
+
+    forward(note);
+}
+
+//------------------------------------------------------------------------------
+static void
+flushRepeats(
+    LogDedup_Client_t*  client,
+    LogDedup_Recent_t*  recent)
+{
+    if (recent->repeats > 0)
+    {
+        forwardNote(&client->last,
+                    recent->level,
+                    recent->lastRepeatMs,
+                    "message repeated %u times: %s",
+                    (unsigned int)recent->repeats,
+                    recent->text);
+        recent->repeats = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+// FNV-1a of the level and the message, never 0.
+static uint64_t
+hashEntry(
+    OS_LoggerEntry_t const* const entry)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    hash ^= entry->emitterMetadata.filteringLevel;
+    hash *= 0x100000001b3ULL;
+
+    for (size_t i = 0; (i < sizeof(entry->msg)) && (entry->msg[i] != '\0'); i++)
+    {
+        hash ^= (uint8_t)entry->msg[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return (0 == hash) ? 1 : hash;
+}
+
+//------------------------------------------------------------------------------
+// Find the recent message with the given hash. Returns NULL if the client has
+// not passed it on within its last LOGSERVER_DEDUP_WINDOW messages.
+static LogDedup_Recent_t*
+findRecent(
+    LogDedup_Client_t*  client,
+    uint64_t            hash)
+{
+    for (size_t i = 0; i < LOGSERVER_DEDUP_WINDOW; i++)
+    {
+        if (client->recent[i].hash == hash)
+        {
+            return &client->recent[i];
+        }
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Remember a message that has been passed on, in place of the one seen least
+// recently. The repeats of that one are written first.
+static void
+addRecent(
+    LogDedup_Client_t*              client,
+    OS_LoggerEntry_t const* const   entry,
+    uint64_t                        hash,
+    uint64_t                        timeMs)
+{
+    LogDedup_Recent_t* recent = &client->recent[0];
+
+    for (size_t i = 1; (recent->hash != 0) && (i < LOGSERVER_DEDUP_WINDOW); i++)
+    {
+        if ((0 == client->recent[i].hash)
+            || (client->recent[i].lastSeenMs < recent->lastSeenMs))
+        {
+            recent = &client->recent[i];
+        }
+    }
+
+    flushRepeats(client, recent);
+
+    recent->hash = hash;
+    recent->level = entry->emitterMetadata.filteringLevel;
+    recent->lastSeenMs = timeMs;
+    snprintf(recent->text, sizeof(recent->text), "%s", entry->msg);
+}
+
+//------------------------------------------------------------------------------
+// The boot trace is written in one burst once per boot, the host tool needs
+// all of its lines. Only the lines of the client that writes it count, and the
+// tag has to start the text of the message, either at the beginning or right
+// after the "<level>: <location>: " the debug macros put in front of it.
+static bool
+isBootTrace(
+    uint32_t                        id,
+    LogDedup_Client_t*              client,
+    OS_LoggerEntry_t const* const   entry)
+{
+    static const char tag[] = BootTrace_LOG_TAG " ";
+
+    if ((id != BOOT_TRACE_CLIENT_ID)
+        || (client->bootTraceLines >= BOOT_TRACE_MAX_LINES))
+    {
+        return false;
+    }
+
+    const char* start = strstr(entry->msg, tag);
+    if ((NULL == start)
+        || ((start != entry->msg)
+            && ((start - entry->msg < 2) || (strncmp(start - 2, ": ", 2) != 0))))
+    {
+        return false;
+    }
+
+    client->bootTraceLines++;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static LogDedup_Bucket_t
+getBucket(
+    uint8_t level)
+{
+    if (level <= Debug_LOG_LEVEL_ERROR)
+    {
+        return BUCKET_ERROR;
+    }
+    if (level == Debug_LOG_LEVEL_WARNING)
+    {
+        return BUCKET_WARNING;
+    }
+    if (level == Debug_LOG_LEVEL_INFO)
+    {
+        return BUCKET_INFO;
+    }
+
+    return BUCKET_DEBUG;
+}
+
+//------------------------------------------------------------------------------
+// Take a token for an entry at timeMs. Returns false if there is none.
+static bool
+takeToken(
+    LogDedup_TokenBucket_t* bucket,
+    uint32_t                rate,
+    uint64_t                timeMs)
+{
+    const uint32_t capacity = LOGSERVER_RATE_LIMIT_BURST * TOKEN;
+
+    if (0 == rate)
+    {
+        return true;
+    }
+
+    if (!bucket->isStarted)
+    {
+        bucket->isStarted = true;
+        bucket->tokens = capacity;
+        bucket->lastMs = timeMs;
+    }
+    else if (timeMs > bucket->lastMs)
+    {
+        uint64_t tokens = bucket->tokens + ((timeMs - bucket->lastMs) * rate);
+        bucket->tokens = (tokens > capacity) ? capacity : (uint32_t)tokens;
+        bucket->lastMs = timeMs;
+    }
+
+    if (bucket->tokens < TOKEN)
+    {
+        return false;
+    }
+
+    bucket->tokens -= TOKEN;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static void
+flushSuppressed(
+    LogDedup_TokenBucket_t*         bucket,
+    OS_LoggerEntry_t const* const   template,
+    uint8_t                         level,
+    uint64_t                        timeMs)
+{
+    forwardNote(template, level, timeMs,
+                "%u messages dropped by the rate limit",
+                bucket->suppressed);
+    bucket->suppressed = 0;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+_Log_format_convert(
+    OS_LoggerAbstractFormat_Handle_t* self,
+    OS_LoggerEntry_t const* const entry)
+{
+    OS_Logger_CHECK_SELF(self);
+
+    if (NULL == entry)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    logDedupMutex_lock();
+
+    uint32_t id = entry->consumerMetadata.id;
+    if (id >= NUM_CLIENT_IDS)
+    {
+        forward(entry);
+
+        logDedupMutex_unlock();
+        return OS_SUCCESS;
+    }
+
+    LogDedup_Client_t* client = &logDedup.clients[id];
+    uint64_t timeMs = entry->consumerMetadata.timestamp;
+    uint64_t hash = hashEntry(entry);
+
+    LogDedup_Recent_t* recent = findRecent(client, hash);
+    if (recent != NULL)
+    {
+        if (0 == recent->repeats)
+        {
+            recent->firstRepeatMs = timeMs;
+        }
+        recent->repeats++;
+        recent->lastRepeatMs = timeMs;
+        recent->lastSeenMs = timeMs;
+
+        logDedupMutex_unlock();
+        return OS_SUCCESS;
+    }
+
+    uint8_t level = entry->emitterMetadata.filteringLevel;
+    LogDedup_Bucket_t idx = getBucket(level);
+    LogDedup_TokenBucket_t* bucket = &client->buckets[idx];
+
+    if (!isBootTrace(id, client, entry)
+        && !takeToken(bucket, rateLimits[idx], timeMs))
+    {
+        bucket->suppressed++;
+        bucket->suppressedLevel = level;
+
+        logDedupMutex_unlock();
+        return OS_SUCCESS;
+    }
+
+    if (bucket->suppressed > 0)
+    {
+        flushSuppressed(bucket, entry, level, timeMs);
+    }
+
+    forward(entry);
+
+    memcpy(&client->last, entry, sizeof(client->last));
+    client->hasLast = true;
+
+    addRecent(client, entry, hash, timeMs);
+
+    logDedupMutex_unlock();
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+_Log_format_print(
+    OS_LoggerAbstractFormat_Handle_t* self)
+{
+    OS_Logger_CHECK_SELF(self);
+
+    return OS_SUCCESS;
+}
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+OS_Error_t
+LogDedup_init(
+    OS_LoggerAbstractFormat_Handle_t* const*    formats,
+    size_t                                      numFormats)
+{
+    if ((NULL == formats) || (0 == numFormats))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    logDedup.formats = formats;
+    logDedup.numFormats = numFormats;
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+void
+LogDedup_flush(
+    uint64_t    nowMs)
+{
+    logDedupMutex_lock();
+
+    for (size_t id = 0; id < NUM_CLIENT_IDS; id++)
+    {
+        LogDedup_Client_t* client = &logDedup.clients[id];
+
+        for (size_t i = 0; i < LOGSERVER_DEDUP_WINDOW; i++)
+        {
+            LogDedup_Recent_t* recent = &client->recent[i];
+
+            if ((recent->repeats > 0)
+                && ((nowMs - recent->firstRepeatMs)
+                    >= LOGSERVER_DEDUP_TIMEOUT_MS))
+            {
+                flushRepeats(client, recent);
+            }
+        }
+
+        // the drops of a client that has gone quiet are reported once the
+        // bucket has a token again
+        for (size_t idx = 0; client->hasLast && (idx < NUM_BUCKETS); idx++)
+        {
+            LogDedup_TokenBucket_t* bucket = &client->buckets[idx];
+
+            if ((bucket->suppressed > 0)
+                && takeToken(bucket, rateLimits[idx], nowMs))
+            {
+                flushSuppressed(bucket, &client->last,
+                                bucket->suppressedLevel, nowMs);
+            }
+        }
+    }
+
+    logDedupMutex_unlock();
+}
@@ -0,0 +1,49 @@
+/*
+ * Deduplication and rate limiting of the log entries.
+ *
+ * The stage sits between the log consumers and the formats that print the
+ * entries. It folds a message that a client repeats within its last
+ * LOGSERVER_DEDUP_WINDOW different messages into one entry "message repeated
+ * N times: <start of the message>", so interleaved repeats are folded as well.
+ * The entry is written after LOGSERVER_DEDUP_TIMEOUT_MS, or earlier if the
+ * message drops out of the window. The other entries pass a token bucket per
+ * client and level class, with the rates of LOGSERVER_RATE_LIMIT_*. An entry
+ * for which there is no token is dropped and counted, the count is reported
+ * once the bucket has a token again. The lines of the boot trace, see
+ * boot_trace.h, are not rate limited.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "Logger/Server/OS_LoggerFormat.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Public variables ----------------------------------------------------------*/
+// Attach it to an output that calls the print() of its format for every
+// entry, the entries that pass are handed on to the formats of
+// LogDedup_init().
+extern OS_LoggerFormat_Handle_t log_dedup_format;
+
+/* Public functions ----------------------------------------------------------*/
+
+// Set the formats the entries that pass are handed on to, in this order. The
+// array must stay valid.
+OS_Error_t
+LogDedup_init(
+    OS_LoggerAbstractFormat_Handle_t* const*    formats,
+    size_t                                      numFormats);
+
+// Write the repeat counts that are older than LOGSERVER_DEDUP_TIMEOUT_MS and
+// the drop counts of the buckets that have a token again. It is called
+// periodically, so the counts are not held back until the client logs again.
+void
+LogDedup_flush(
+    uint64_t    nowMs);
@@ -14,23 +14,47 @@
 #include "if_NetworkStack_PicoTcp_Config.h"
 #include "lib_debug/Debug.h"
 
-#include "helper_func.h"
+#include "config_bulk.h"
+#include "config_params.h"
+#include "config_snapshot.h"
+#include "boot_trace.h"
 
 #include <camkes.h>
 
 /* Defines -------------------------------------------------------------------*/
-// the following defines are the parameter names that need to match the settings
-// in the configuration xml file. These will be passed to the configServer
-// component to retrieve the settings for the specified parameter
-#define DOMAIN_NWSTACK   "Domain-NwStack"
-#define ETH_ADDR         "ETH_ADDR"
-#define ETH_GATEWAY_ADDR "ETH_GATEWAY_ADDR"
-#define ETH_SUBNET_MASK  "ETH_SUBNET_MASK"
+// the parameter names are generated from the configuration xml file into
+// config_params.h
+#define DOMAIN_NWSTACK   CONFIG_NW_STACK_NAME
+#define ETH_ADDR         CONFIG_NW_STACK_ETH_ADDR_NAME
+#define ETH_GATEWAY_ADDR CONFIG_NW_STACK_ETH_GATEWAY_ADDR_NAME
+#define ETH_SUBNET_MASK  CONFIG_NW_STACK_ETH_SUBNET_MASK_NAME
 
 //------------------------------------------------------------------------------
 static const if_NetworkStack_PicoTcp_Config_t networkStackConfig =
     if_NetworkStack_PicoTcp_Config_ASSIGN(networkStack_PicoTcp_Config);
 
+static const if_ConfigServerBulk_t configServer =
+    IF_CONFIGSERVERBULK_ASSIGN(
+        configServerBulk_rpc,
+        configServer_port);
+
+static const ConfigSnapshot_t configSnapshot =
+    ConfigSnapshot_ASSIGN(
+        configSnapshot_port,
+        CONFIG_SNAPSHOT_SIZE);
+
+static const if_OS_Timer_t timer =
+    IF_OS_TIMER_ASSIGN(
+        timeServer_rpc,
+        timeServer_notify);
+
+static const BootTrace_t bootTrace =
+    BootTrace_ASSIGN(
+        bootTrace_port,
+        &timer,
+        BOOT_TRACE_NWSTACKCONFIG_SLOT,
+        "NwStackConfig");
+
 //------------------------------------------------------------------------------
 static
 OS_Error_t
@@ -40,65 +64,58 @@ read_ip_from_config_server(
     const char* gatewayAddrParamName,
     const char* subnetMaskParamName)
 {
-    OS_Error_t ret;
-    // Create a handle to the remote library instance.
-    OS_ConfigServiceHandle_t hConfig;
-
-    static OS_ConfigService_ClientCtx_t ctx =
+    // the call returns once the ConfigServer has published the snapshot, the
+    // parameters are then read from it without any further RPC
+    unsigned int version;
+    OS_Error_t ret = configServer.getSnapshotVersion(&version);
+    if ((ret != OS_SUCCESS) || (0 == version))
     {
-        .dataport = OS_DATAPORT_ASSIGN(configServer_port)
-    };
-
-    ret = OS_ConfigService_createHandleRemote(
-              &ctx,
-              &hConfig);
-    if (ret != OS_SUCCESS)
-    {
-        Debug_LOG_ERROR("OS_ConfigService_createHandleRemote() failed with :%d",
-                        ret);
-        return ret;
+        Debug_LOG_ERROR("No config snapshot available, version %u, code %d",
+                        version, ret);
+        return OS_ERROR_NOT_INITIALIZED;
     }
 
-    // Get the needed param values one by one from config server, using the
-    // helper library wrapping around the ConfigServer API.
-    ret = helper_func_getConfigParameter(&hConfig,
-                                         DOMAIN_NWSTACK,
-                                         devAddrParamName,
-                                         ipAddrConfig->dev_addr,
-                                         sizeof(ipAddrConfig->dev_addr));
-    if (ret != OS_SUCCESS)
+    const struct
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s "
-                        "failed with :%d", devAddrParamName, ret);
-        return ret;
+        const char* name;
+        char*       buffer;
+        size_t      bufferSize;
     }
-    Debug_LOG_INFO("Retrieved IP ADDR: %s", ipAddrConfig->dev_addr);
-
-    ret = helper_func_getConfigParameter(&hConfig,
-                                         DOMAIN_NWSTACK,
-                                         gatewayAddrParamName,
-                                         ipAddrConfig->gateway_addr,
-                                         sizeof(ipAddrConfig->gateway_addr));
-    if (ret != OS_SUCCESS)
+    parameters[] =
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s "
-                        "failed with :%d", gatewayAddrParamName, ret);
-        return ret;
-    }
-    Debug_LOG_INFO("Retrieved GATEWAY ADDR: %s", ipAddrConfig->gateway_addr);
+        {
+            devAddrParamName,
+            ipAddrConfig->dev_addr,
+            sizeof(ipAddrConfig->dev_addr)
+        },
+        {
+            gatewayAddrParamName,
+            ipAddrConfig->gateway_addr,
+            sizeof(ipAddrConfig->gateway_addr)
+        },
+        {
+            subnetMaskParamName,
+            ipAddrConfig->subnet_mask,
+            sizeof(ipAddrConfig->subnet_mask)
+        },
+    };
 
-    ret = helper_func_getConfigParameter(
-              &hConfig,
-              DOMAIN_NWSTACK,
-              subnetMaskParamName,
-              ipAddrConfig->subnet_mask,
-              sizeof(ipAddrConfig->subnet_mask));
-    if (ret != OS_SUCCESS)
+    for (size_t i = 0; i < (sizeof(parameters) / sizeof(parameters[0])); i++)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s "
-                        "failed with :%d", subnetMaskParamName, ret);
-        return ret;
+        ret = ConfigSnapshot_getParameter(&configSnapshot,
+                                          DOMAIN_NWSTACK,
+                                          parameters[i].name,
+                                          parameters[i].buffer,
+                                          parameters[i].bufferSize);
+        if (ret != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("ConfigSnapshot_getParameter() for param %s "
+                            "failed with :%d", parameters[i].name, ret);
+            return ret;
+        }
     }
+    Debug_LOG_INFO("Retrieved IP ADDR: %s", ipAddrConfig->dev_addr);
+    Debug_LOG_INFO("Retrieved GATEWAY ADDR: %s", ipAddrConfig->gateway_addr);
     Debug_LOG_INFO("Retrieved SUBNETMASK: %s", ipAddrConfig->subnet_mask);
 
     return OS_SUCCESS;
@@ -110,6 +127,8 @@ post_init(void)
 {
     OS_NetworkStack_AddressConfig_t ipAddrConfig;
 
+    BOOT_TRACE_MARK(&bootTrace, "post_init");
+
     OS_Error_t ret = read_ip_from_config_server(
                          &ipAddrConfig,
                          ETH_ADDR,
@@ -120,6 +139,7 @@ post_init(void)
         Debug_LOG_FATAL("Read from config failed, error %d", ret);
         return;
     }
+    BOOT_TRACE_MARK(&bootTrace, "config_read");
 
     ret = networkStackConfig.configIpAddr(&ipAddrConfig);
     if (ret != OS_SUCCESS)
@@ -128,4 +148,5 @@ post_init(void)
                         ret);
         return;
     }
+    BOOT_TRACE_MARK(&bootTrace, "stack_configured");
 }
@@ -12,7 +12,11 @@
 
 #include "OS_ConfigService.h"
 
-#include "helper_func.h"
+#include "config_bulk.h"
+#include "config_params.h"
+#include "config_snapshot.h"
+#include "boot_trace.h"
+#include "trace.h"
 
 #include "MQTTPacket.h"
 
@@ -21,37 +25,61 @@
 #include "time.h"
 
 /* Defines -------------------------------------------------------------------*/
-// the following defines are the parameter names that need to match the settings
-// in the configuration xml file. These will be passed to the configServer
-// component to retrieve the settings for the specified parameter
-#define DOMAIN_SENSOR           "Domain-Sensor"
-#define MQTT_PAYLOAD_NAME       "MQTT_Payload" // _NAME defines are stored together with the values in the config file
-#define MQTT_TOPIC_NAME         "MQTT_Topic"
+// the names and sizes of the parameters are generated from the configuration
+// xml file into config_params.h
+#define DOMAIN_SENSOR           CONFIG_SENSOR_NAME
+#define MQTT_PAYLOAD_NAME       CONFIG_SENSOR_MQTT_PAYLOAD_NAME
+#define MQTT_TOPIC_NAME         CONFIG_SENSOR_MQTT_TOPIC_NAME
 
 // send a new message to the cloudConnector every five seconds
 #define SEC_TO_SLEEP   5
 
-OS_ConfigServiceHandle_t hConfig;
-
-static unsigned char payload[128]; // arbitrary max expected length
-static char topic[128];
+static const if_ConfigServerBulk_t configServer =
+    IF_CONFIGSERVERBULK_ASSIGN(
+        configServerBulk_rpc,
+        configServer_port);
+
+static const ConfigSnapshot_t configSnapshot =
+    ConfigSnapshot_ASSIGN(
+        configSnapshot_port,
+        CONFIG_SNAPSHOT_SIZE);
+
+static const if_OS_Timer_t timer =
+    IF_OS_TIMER_ASSIGN(
+        timeServer_rpc,
+        timeServer_notify);
+
+static const BootTrace_t bootTrace =
+    BootTrace_ASSIGN(
+        bootTrace_port,
+        &timer,
+        BOOT_TRACE_SENSOR_SLOT,
+        "Sensor");
+
+// Both are used as strings. The topic can be changed at runtime, but the
+// ConfigServer denies any topic larger than the generated size.
+static unsigned char payload[CONFIG_SENSOR_MQTT_PAYLOAD_SIZE + 1];
+static char topic[CONFIG_SENSOR_MQTT_TOPIC_SIZE + 1];
+
+// fixed header (1 byte type, up to 4 bytes remaining length), length of the
+// topic and packet id, each 2 bytes
+#define MQTT_PUBLISH_OVERHEAD   (1 + 4 + 2 + 2)
+
+static unsigned char serializedMsg[MQTT_PUBLISH_OVERHEAD
+                                   + CONFIG_SENSOR_MQTT_TOPIC_SIZE
+                                   + CONFIG_SENSOR_MQTT_PAYLOAD_SIZE];
+static int serializedMsgLen;
+
+// version of the sensor domain the message was built from
+static uint32_t configVersion;
+
+// messages passed to the CloudConnector, the number of a message is its trace
+// id for the tracepoints
+static uint32_t numMessages;
 
 static OS_Error_t
 initializeSensor(void)
 {
-    static OS_ConfigService_ClientCtx_t ctx =
-    {
-        .dataport = OS_DATAPORT_ASSIGN(configServer_port)
-    };
-    OS_Error_t err = OS_ConfigService_createHandleRemote(
-                         &ctx,
-                         &hConfig);
-    if (err != OS_SUCCESS)
-    {
-        Debug_LOG_ERROR("OS_ConfigService_createHandleRemote() failed with :%d", err);
-        return err;
-    }
-
     // set up a tick with the local timer ID 1. The local timer ID 0 is used for
     // the sleep() function of the TimeServer
     int ret = timeServer_rpc_periodic(1, (NS_IN_S*SEC_TO_SLEEP));
@@ -61,60 +89,74 @@ initializeSensor(void)
         return -1;
     }
 
+    // the call returns once the ConfigServer has published the snapshot
+    unsigned int version;
+    OS_Error_t err = configServer.getSnapshotVersion(&version);
+    if ((err != OS_SUCCESS) || (0 == version))
+    {
+        Debug_LOG_ERROR("No config snapshot available, version %u, code %d",
+                        version, err);
+        return OS_ERROR_NOT_INITIALIZED;
+    }
+
     return OS_SUCCESS;
 }
 
 static OS_Error_t
-CloudConnector_write(unsigned char* msg, void* dataPort, size_t len)
-{
-    memcpy(dataPort, msg, len);
-    OS_Error_t err = cloudConnector_rpc_write();
-    return err;
-}
-
-
-int run()
+readConfig(void)
 {
-    OS_Error_t ret = initializeSensor();
-    if (ret != OS_SUCCESS)
+    OS_Error_t err = ConfigSnapshot_getParameter(&configSnapshot,
+                                                 DOMAIN_SENSOR,
+                                                 MQTT_PAYLOAD_NAME,
+                                                 payload,
+                                                 sizeof(payload));
+    if (err != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("initializeSensor() failed with:%d", ret);
-        return ret;
+        Debug_LOG_ERROR("ConfigSnapshot_getParameter() for param %s failed with :%d",
+                        MQTT_PAYLOAD_NAME, err);
+        return err;
     }
 
-    Debug_LOG_INFO("Starting TemperatureSensor...");
-
-    ret = helper_func_getConfigParameter(&hConfig,
-                                         DOMAIN_SENSOR,
-                                         MQTT_PAYLOAD_NAME,
-                                         &payload,
-                                         sizeof(payload));
-    if (ret != OS_SUCCESS)
+    err = ConfigSnapshot_getParameter(&configSnapshot,
+                                      DOMAIN_SENSOR,
+                                      MQTT_TOPIC_NAME,
+                                      topic,
+                                      sizeof(topic) - 1);
+    if (err != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s failed with :%d",
-                        MQTT_PAYLOAD_NAME, ret);
-        return ret;
+        Debug_LOG_ERROR("ConfigSnapshot_getParameter() for param %s failed with :%d",
+                        MQTT_TOPIC_NAME, err);
+        return err;
     }
-    Debug_LOG_INFO("Retrieved MQTT Payload: %s", payload);
 
+    return OS_SUCCESS;
+}
 
-    ret = helper_func_getConfigParameter(&hConfig,
-                                         DOMAIN_SENSOR,
-                                         MQTT_TOPIC_NAME,
-                                         &topic,
-                                         sizeof(topic));
+static OS_Error_t
+CloudConnector_write(unsigned char* msg, void* dataPort, size_t len,
+                     uint32_t traceId, uint64_t sampleTimeNs)
+{
+    memcpy(dataPort, msg, len);
+    OS_Error_t err = cloudConnector_rpc_write(traceId, sampleTimeNs);
+    return err;
+}
+
+
+static OS_Error_t
+updateMessage(void)
+{
+    OS_Error_t ret = readConfig();
     if (ret != OS_SUCCESS)
     {
-        Debug_LOG_ERROR("helper_func_getConfigParameter() for param %s failed with :%d",
-                        MQTT_TOPIC_NAME, ret);
+        Debug_LOG_ERROR("readConfig() failed with:%d", ret);
         return ret;
     }
+    Debug_LOG_INFO("Retrieved MQTT Payload: %s", payload);
 
     MQTTString mqttTopic = MQTTString_initializer;
     mqttTopic.cstring = topic;
     Debug_LOG_INFO("Retrieved MQTT Topic: %s", mqttTopic.cstring);
 
-    unsigned char serializedMsg[320]; //arbitrary size
     int len = MQTTSerialize_publish(serializedMsg,
                                     sizeof(serializedMsg),
                                     0,
@@ -124,11 +166,82 @@ int run()
                                     mqttTopic,
                                     (unsigned char*)payload,
                                     strlen((const char*)payload));
+    if (len <= 0)
+    {
+        Debug_LOG_ERROR("MQTTSerialize_publish() failed with:%d", len);
+        return OS_ERROR_GENERIC;
+    }
+
+    serializedMsgLen = len;
+
+    return OS_SUCCESS;
+}
+
+
+int run()
+{
+    BOOT_TRACE_MARK(&bootTrace, "run");
+    TRACE_INIT(trace_port, &timer);
+
+    OS_Error_t ret = initializeSensor();
+    if (ret != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("initializeSensor() failed with:%d", ret);
+        return ret;
+    }
+    BOOT_TRACE_MARK(&bootTrace, "snapshot_ready");
+
+    Debug_LOG_INFO("Starting TemperatureSensor...");
+
+    // the first check always reports a change, so the message is built here
+    ConfigSnapshot_hasDomainChanged(&configSnapshot,
+                                    DOMAIN_SENSOR,
+                                    &configVersion);
+    ret = updateMessage();
+    if (ret != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("updateMessage() failed with:%d", ret);
+        return ret;
+    }
+
+    // the CloudConnector queues the messages until it is connected, so this
+    // is the time the first message is ready, not when it is published
+    BOOT_TRACE_MARK(&bootTrace, "first_message");
 
     for (;;)
     {
-        CloudConnector_write(serializedMsg, (void*)cloudConnector_port,
-                             len);
+        // a changed topic or payload is used from the next message on, if
+        // the new values can't be used the previous message is kept
+        if (ConfigSnapshot_hasDomainChanged(&configSnapshot,
+                                            DOMAIN_SENSOR,
+                                            &configVersion))
+        {
+            Debug_LOG_INFO("Configuration of %s changed", DOMAIN_SENSOR);
+
+            ret = updateMessage();
+            if (ret != OS_SUCCESS)
+            {
+                Debug_LOG_WARNING("updateMessage() failed with:%d, keeping previous message",
+                                  ret);
+            }
+        }
+
+        // the time of the reading goes with the message, so the latency of
+        // every stage on its way to the cloud can be attributed
+        uint64_t sampleTimeNs;
+        if (TimeServer_getTime(&timer, TimeServer_PRECISION_NSEC,
+                               &sampleTimeNs) != OS_SUCCESS)
+        {
+            sampleTimeNs = 0;
+        }
+
+        numMessages++;
+        TRACE_POINT(SENSOR_SAMPLE, numMessages);
+        TRACE_POINT(SENSOR_WRITE_START, numMessages, serializedMsgLen);
+        ret = CloudConnector_write(serializedMsg, (void*)cloudConnector_port,
+                                   serializedMsgLen, numMessages,
+                                   sampleTimeNs);
+        TRACE_POINT(SENSOR_WRITE_DONE, numMessages, ret);
 
         timeServer_notify_wait();
     }
@@ -9,16 +9,103 @@
 #include "lib_debug/Debug.h"
 #include <camkes.h>
 
-#define DATABUFFER_CLIENT       (void *)logServer_port
+#include "log_ring.h"
+
+#define LOG_RING_CLIENT         ((LogRing_t*)logServer_port)
 
 static OS_LoggerFilter_Handle_t filter;
+static OS_LoggerFilter_Handle_t levelFilter;
+static uint8_t filterLevel = Debug_LOG_LEVEL_DEBUG;
+
+// The emitter fills this buffer and the entry is then appended to the ring in
+// the log dataport, so logging does not wait for the LogServer.
+static char logEntry[DATABUFFER_SIZE];
+
+// More than one thread of a component logs, e.g. run() and an RPC thread, but
+// there is just one buffer and the ring takes entries from one thread at a
+// time. The emitter asks the filter before it formats an entry into the
+// buffer, so the filter takes the lock for an entry that passes and
+// emitToRing() releases it once the entry is in the ring. The level is checked
+// by levelFilter, which is only used with the lock held.
+static OS_LoggerAbstractFilter_vtable_t lockingFilterVtable;
+static uint32_t isLogLocked;
+
+static void
+lockLog(void)
+{
+    while (__atomic_exchange_n(&isLogLocked, 1, __ATOMIC_ACQUIRE))
+    {
+        seL4_Yield();
+    }
+}
+
+static void
+unlockLog(void)
+{
+    __atomic_store_n(&isLogLocked, 0, __ATOMIC_RELEASE);
+}
+
+static bool
+filterAndLock(
+    OS_LoggerAbstractFilter_Handle_t*   self,
+    uint8_t                             level)
+{
+    lockLog();
+
+    OS_LoggerAbstractFilter_Handle_t* levelCheck =
+        (OS_LoggerAbstractFilter_Handle_t*)&levelFilter;
+
+    if (!levelCheck->vtable->filtering(levelCheck, level))
+    {
+        unlockLog();
+        return false;
+    }
+
+    return true;
+}
+
+// The filter of the emitter is a level filter whose check takes the lock.
+static void
+initFilter(void)
+{
+    OS_LoggerFilter_ctor(&levelFilter, filterLevel);
+    OS_LoggerFilter_ctor(&filter, filterLevel);
+
+    lockingFilterVtable = *filter.vtable;
+    lockingFilterVtable.filtering = filterAndLock;
+    filter.vtable = &lockingFilterVtable;
+}
+
+static void
+notifyLogServer(void)
+{
+    logServer_notify_emit();
+}
+
+// The LogServer publishes the level of the client in the ring, it is taken
+// over with the next entry that passes the current filter. Entries below the
+// new level are then not formatted at all. Called with the lock held.
+static void
+emitToRing(void)
+{
+    uint8_t level;
+    if (LogRing_getLevel(LOG_RING_CLIENT, &level) && (level != filterLevel))
+    {
+        filterLevel = level;
+        OS_LoggerFilter_ctor(&levelFilter, filterLevel);
+    }
+
+    LogRing_push(LOG_RING_CLIENT, logEntry, notifyLogServer);
+
+    unlockLog();
+}
 
 void pre_init(void)
 {
-    OS_LoggerFilter_ctor(&filter, Debug_LOG_LEVEL_DEBUG);
+    initFilter();
 
     OS_LoggerEmitter_getInstance(
-        DATABUFFER_CLIENT,
+        logEntry,
         &filter,
-        API_LOG_SERVER_EMIT);
+        emitToRing);
 }
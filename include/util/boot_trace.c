@@ -0,0 +1,101 @@
+/*
+ * Boot phase tracing across components.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <string.h>
+
+#include "lib_debug/Debug.h"
+#include "lib_debug/Debug_OS_Error.h"
+
+#include "boot_trace.h"
+
+_Static_assert(sizeof(BootTrace_Buffer_t) <= 4096,
+               "boot trace does not fit into a dataport page");
+
+// Private functions -----------------------------------------------------------
+
+//------------------------------------------------------------------------------
+static
+BootTrace_Buffer_t*
+getBuffer(
+    const BootTrace_t* self)
+{
+    return *self->io;
+}
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+void
+BootTrace_mark(
+    const BootTrace_t*  self,
+    const char*         phase)
+{
+    uint64_t ns;
+
+    OS_Error_t err = TimeServer_getTime(
+                         self->timer,
+                         TimeServer_PRECISION_NSEC,
+                         &ns);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("TimeServer_getTime() failed , code '%s'",
+                        Debug_OS_Error_toString(err));
+        return;
+    }
+
+    if (self->slot >= BootTrace_MAX_COMPONENTS)
+    {
+        return;
+    }
+
+    BootTrace_Slot_t* slot = &getBuffer(self)->slots[self->slot];
+    uint32_t idx = slot->numEntries;
+    if (idx >= BootTrace_MAX_PHASES)
+    {
+        return;
+    }
+
+    if (0 == idx)
+    {
+        strncpy(slot->component, self->component, sizeof(slot->component) - 1);
+    }
+
+    BootTrace_Entry_t* entry = &slot->entries[idx];
+    entry->timeNs = ns;
+    strncpy(entry->phase, phase, sizeof(entry->phase) - 1);
+
+    // the entry is complete before another component can see it
+    __atomic_store_n(&slot->numEntries, idx + 1, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+void
+BootTrace_dump(
+    const BootTrace_t*  self)
+{
+    const BootTrace_Buffer_t* buffer = getBuffer(self);
+
+    for (size_t i = 0; i < BootTrace_MAX_COMPONENTS; i++)
+    {
+        const BootTrace_Slot_t* slot = &buffer->slots[i];
+        uint32_t numEntries = __atomic_load_n(&slot->numEntries,
+                                              __ATOMIC_ACQUIRE);
+
+        for (size_t j = 0; (j < numEntries) && (j < BootTrace_MAX_PHASES); j++)
+        {
+            const BootTrace_Entry_t* entry = &slot->entries[j];
+
+            Debug_LOG_INFO(BootTrace_LOG_TAG " %.*s %.*s %llu",
+                           (int)sizeof(slot->component), slot->component,
+                           (int)sizeof(entry->phase), entry->phase,
+                           (unsigned long long)entry->timeNs);
+        }
+    }
+}
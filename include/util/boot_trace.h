@@ -0,0 +1,92 @@
+/*
+ * Boot phase tracing across components.
+ *
+ * Every component that takes part in the start-up maps the same small
+ * dataport and records the time of its boot phases into its own slot, so no
+ * locking between the components is needed. All times come from the
+ * TimeServer and share one time base. Once the first message has been
+ * published, the CloudConnector writes all slots to the log, from where
+ * tools/boot_timeline.py renders them as a timeline.
+ *
+ * Tracing is enabled with BOOT_TRACE, otherwise BOOT_TRACE_MARK() compiles to
+ * nothing.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "TimeServer.h"
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+#define BootTrace_MAX_COMPONENTS    8
+#define BootTrace_MAX_PHASES        12
+#define BootTrace_NAME_SIZE         24
+
+// The trace is written to the log with this tag, the host tool looks for it.
+#define BootTrace_LOG_TAG           "BOOT_TRACE"
+
+typedef struct
+{
+    uint64_t    timeNs;
+    char        phase[BootTrace_NAME_SIZE];
+} BootTrace_Entry_t;
+
+typedef struct
+{
+    char                component[16];
+    uint32_t            numEntries;     // written after the entry
+    uint32_t            reserved;
+    BootTrace_Entry_t   entries[BootTrace_MAX_PHASES];
+} BootTrace_Slot_t;
+
+// The layout of the shared dataport, it must fit into one page.
+typedef struct
+{
+    BootTrace_Slot_t    slots[BootTrace_MAX_COMPONENTS];
+} BootTrace_Buffer_t;
+
+// The mapping of the trace dataport in a component and the slot it writes to.
+typedef struct
+{
+    void**                  io;
+    const if_OS_Timer_t*    timer;
+    unsigned int            slot;
+    const char*             component;
+} BootTrace_t;
+
+#define BootTrace_ASSIGN(_port_, _timer_, _slot_, _component_)  \
+{                                                               \
+    .io         = (void**)&(_port_),                            \
+    .timer      = (_timer_),                                    \
+    .slot       = (_slot_),                                     \
+    .component  = (_component_)                                 \
+}
+
+#if defined(BOOT_TRACE)
+#define BOOT_TRACE_MARK(_trace_, _phase_)   BootTrace_mark(_trace_, _phase_)
+#define BOOT_TRACE_DUMP(_trace_)            BootTrace_dump(_trace_)
+#else
+#define BOOT_TRACE_MARK(_trace_, _phase_)   ((void)(_trace_))
+#define BOOT_TRACE_DUMP(_trace_)            ((void)(_trace_))
+#endif
+
+//------------------------------------------------------------------------------
+// Record the current time for a phase in the slot of the component. Phases
+// beyond BootTrace_MAX_PHASES are dropped.
+void
+BootTrace_mark(
+    const BootTrace_t*  self,
+    const char*         phase);
+
+//------------------------------------------------------------------------------
+// Write the phases of all components to the log.
+void
+BootTrace_dump(
+    const BootTrace_t*  self);
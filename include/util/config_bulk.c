@@ -0,0 +1,144 @@
+/*
+ * Bulk access to the ConfigServer.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <string.h>
+
+#include "lib_debug/Debug.h"
+
+#include "config_bulk.h"
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigBulk_getParameters(
+    const if_ConfigServerBulk_t*    configServer,
+    const char*                     domainName,
+    ConfigBulk_Parameter_t*         parameters,
+    size_t                          numParameters)
+{
+    if ((NULL == configServer) || (NULL == domainName)
+        || (NULL == parameters))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    uint8_t* buf = OS_Dataport_getBuf(configServer->dataport);
+    size_t bufSize = OS_Dataport_getSize(configServer->dataport);
+
+    if ((numParameters * sizeof(ConfigBulk_Record_t)) > bufSize)
+    {
+        Debug_LOG_ERROR("Too many parameters for one request: %zu",
+                        numParameters);
+        return OS_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    // the request is a list of records that carry just the names
+    ConfigBulk_Record_t* request = (ConfigBulk_Record_t*)buf;
+    for (size_t i = 0; i < numParameters; i++)
+    {
+        memset(&request[i], 0, sizeof(request[i]));
+        strncpy(request[i].name,
+                parameters[i].name,
+                sizeof(request[i].name) - 1);
+    }
+
+    OS_Error_t err = configServer->getParameters(domainName, numParameters);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("getParameters() for %s failed with: %d",
+                        domainName, err);
+        return err;
+    }
+
+    // the response has a record with status and value for every parameter
+    OS_Error_t ret = OS_SUCCESS;
+    size_t pos = 0;
+    for (size_t i = 0; i < numParameters; i++)
+    {
+        ConfigBulk_Parameter_t* param = &parameters[i];
+
+        if ((bufSize - pos) < sizeof(ConfigBulk_Record_t))
+        {
+            Debug_LOG_ERROR("Record %zu exceeds the dataport", i);
+            return OS_ERROR_INVALID_STATE;
+        }
+
+        const ConfigBulk_Record_t* record =
+            (const ConfigBulk_Record_t*)&buf[pos];
+        size_t recordSize = ConfigBulk_RECORD_SIZE(record->size);
+        if (recordSize > (bufSize - pos))
+        {
+            Debug_LOG_ERROR("Value of record %zu exceeds the dataport", i);
+            return OS_ERROR_INVALID_STATE;
+        }
+        pos += recordSize;
+
+        param->status = record->status;
+        if ((OS_SUCCESS == param->status)
+            && (record->size > param->bufferSize))
+        {
+            param->status = OS_ERROR_BUFFER_TOO_SMALL;
+        }
+
+        if (param->status != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("Parameter %s of %s failed with: %d",
+                            param->name, domainName, param->status);
+            if (OS_SUCCESS == ret)
+            {
+                ret = param->status;
+            }
+            continue;
+        }
+
+        memcpy(param->buffer, &record[1], record->size);
+        memset((uint8_t*)param->buffer + record->size,
+               0,
+               param->bufferSize - record->size);
+    }
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigBulk_setParameter(
+    const if_ConfigServerBulk_t*    configServer,
+    const char*                     domainName,
+    const char*                     parameterName,
+    const void*                     value,
+    size_t                          valueSize)
+{
+    if ((NULL == configServer) || (NULL == domainName)
+        || (NULL == parameterName) || (NULL == value))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (valueSize > OS_Dataport_getSize(configServer->dataport))
+    {
+        Debug_LOG_ERROR("Value of %s too big for the dataport: %zu",
+                        parameterName, valueSize);
+        return OS_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    memcpy(OS_Dataport_getBuf(configServer->dataport), value, valueSize);
+
+    OS_Error_t err = configServer->setParameter(domainName,
+                                                parameterName,
+                                                valueSize);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("setParameter() for %s of %s failed with: %d",
+                        parameterName, domainName, err);
+        return err;
+    }
+
+    return OS_SUCCESS;
+}
@@ -0,0 +1,106 @@
+/*
+ * Bulk access to the ConfigServer.
+ *
+ * The clients access the ConfigServer with the if_ConfigServerBulk interface
+ * only. It packs the parameters of a domain into the dataport of the calling
+ * client, so a client gets a complete domain with a single RPC instead of
+ * walking the domains and fetching every parameter on its own. A client that
+ * needs only some parameters of a domain gets them with a single call, too.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "OS_ConfigService.h"
+#include "OS_Dataport.h"
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Every parameter is stored as a record in the dataport. The records follow
+// each other without a gap, the value of a record is padded to a multiple of
+// ConfigBulk_RECORD_ALIGN bytes.
+#define ConfigBulk_RECORD_ALIGN     4
+
+#define ConfigBulk_ALIGN(_size_) \
+    (((_size_) + (ConfigBulk_RECORD_ALIGN - 1)) \
+     & ~((size_t)ConfigBulk_RECORD_ALIGN - 1))
+
+typedef struct
+{
+    char        name[OS_CONFIG_LIB_PARAMETER_NAME_SIZE];
+    int32_t     status; // OS_Error_t of the lookup of this parameter
+    uint32_t    type;   // OS_ConfigServiceLibTypes_ParameterType_t
+    uint32_t    size;   // size of the value following the record header
+} ConfigBulk_Record_t;
+
+#define ConfigBulk_RECORD_SIZE(_valueSize_) \
+    (sizeof(ConfigBulk_Record_t) + ConfigBulk_ALIGN(_valueSize_))
+
+//------------------------------------------------------------------------------
+// Client side of the if_ConfigServerBulk interface.
+typedef struct
+{
+    OS_Error_t (*getDomain)(
+        const char*     domainName,
+        unsigned int    firstParameter,
+        unsigned int*   numParameters,
+        unsigned int*   numRemaining);
+    OS_Error_t (*getParameters)(
+        const char*     domainName,
+        unsigned int    numParameters);
+    OS_Error_t (*setParameter)(
+        const char*     domainName,
+        const char*     parameterName,
+        unsigned int    valueSize);
+    OS_Error_t (*getSnapshotVersion)(
+        unsigned int*   version);
+    OS_Dataport_t dataport;
+} if_ConfigServerBulk_t;
+
+#define IF_CONFIGSERVERBULK_ASSIGN(_rpc_, _port_)           \
+{                                                           \
+    .getDomain          = _rpc_##_getDomain,                \
+    .getParameters      = _rpc_##_getParameters,            \
+    .setParameter       = _rpc_##_setParameter,             \
+    .getSnapshotVersion = _rpc_##_getSnapshotVersion,       \
+    .dataport           = OS_DATAPORT_ASSIGN(_port_)        \
+}
+
+//------------------------------------------------------------------------------
+// One parameter of a ConfigBulk_getParameters() call. The value is copied into
+// the buffer, any remaining space in the buffer is cleared.
+typedef struct
+{
+    const char* name;
+    void*       buffer;
+    size_t      bufferSize;
+    OS_Error_t  status;
+} ConfigBulk_Parameter_t;
+
+//------------------------------------------------------------------------------
+// Get several parameters of a domain with a single RPC. The status of every
+// parameter is returned in its entry, the function fails if the RPC failed or
+// any of the parameters could not be retrieved.
+OS_Error_t
+ConfigBulk_getParameters(
+    const if_ConfigServerBulk_t*    configServer,
+    const char*                     domainName,
+    ConfigBulk_Parameter_t*         parameters,
+    size_t                          numParameters);
+
+//------------------------------------------------------------------------------
+// Set the value of a parameter. All clients that watch the domain of the
+// parameter in the config snapshot see the change.
+OS_Error_t
+ConfigBulk_setParameter(
+    const if_ConfigServerBulk_t*    configServer,
+    const char*                     domainName,
+    const char*                     parameterName,
+    const void*                     value,
+    size_t                          valueSize);
@@ -0,0 +1,348 @@
+/*
+ * Client side cache for the parameters of a ConfigServer domain.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <string.h>
+
+#include "config_cache.h"
+
+//------------------------------------------------------------------------------
+// FNV-1a hash of a name, limited to the given maximum length
+static
+uint32_t
+hashName(
+    const char* name,
+    size_t maxLen)
+{
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; (i < maxLen) && (name[i] != '\0'); i++)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+static
+void
+insertSlot(
+    ConfigCache_t* self,
+    uint32_t hash,
+    size_t entryIdx)
+{
+    size_t slot = hash & (CONFIG_CACHE_SLOTS - 1);
+
+    // there are always more slots than entries, so a free slot is found
+    while (self->slots[slot] != 0)
+    {
+        slot = (slot + 1) & (CONFIG_CACHE_SLOTS - 1);
+    }
+
+    self->slots[slot] = (uint16_t)(entryIdx + 1);
+}
+
+//------------------------------------------------------------------------------
+static
+const ConfigCache_Entry_t*
+findEntry(
+    const ConfigCache_t* self,
+    const char* parameterName)
+{
+    uint32_t hash = hashName(parameterName, OS_CONFIG_LIB_PARAMETER_NAME_SIZE);
+
+    for (size_t slot = hash & (CONFIG_CACHE_SLOTS - 1);
+         self->slots[slot] != 0;
+         slot = (slot + 1) & (CONFIG_CACHE_SLOTS - 1))
+    {
+        const ConfigCache_Entry_t* entry = &self->entries[self->slots[slot] - 1];
+        if ((entry->hash == hash)
+            && (0 == strncmp(entry->name,
+                             parameterName,
+                             OS_CONFIG_LIB_PARAMETER_NAME_SIZE)))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+copyEntry(
+    const ConfigCache_t* self,
+    const ConfigCache_Entry_t* entry,
+    void* parameterBuffer,
+    size_t parameterLength)
+{
+    if (entry->size > parameterLength)
+    {
+        Debug_LOG_ERROR("Buffer too small for parameter %s, needs %zu bytes",
+                        entry->name, entry->size);
+        return OS_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    memcpy(parameterBuffer, &self->data[entry->offset], entry->size);
+    memset((uint8_t*)parameterBuffer + entry->size,
+           0,
+           parameterLength - entry->size);
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+addRecords(
+    ConfigCache_t* self,
+    const uint8_t* buf,
+    size_t bufSize,
+    unsigned int numRecords)
+{
+    size_t pos = 0;
+
+    for (unsigned int i = 0; i < numRecords; i++)
+    {
+        if ((bufSize - pos) < sizeof(ConfigBulk_Record_t))
+        {
+            Debug_LOG_ERROR("Record %u exceeds the dataport", i);
+            return OS_ERROR_INVALID_STATE;
+        }
+
+        const ConfigBulk_Record_t* record =
+            (const ConfigBulk_Record_t*)&buf[pos];
+        size_t recordSize = ConfigBulk_RECORD_SIZE(record->size);
+
+        if (recordSize > (bufSize - pos))
+        {
+            Debug_LOG_ERROR("Value of record %u exceeds the dataport", i);
+            return OS_ERROR_INVALID_STATE;
+        }
+
+        if (self->numEntries >= CONFIG_CACHE_MAX_ENTRIES)
+        {
+            Debug_LOG_ERROR("Too many parameters in %s, max is %d",
+                            self->domain, CONFIG_CACHE_MAX_ENTRIES);
+            return OS_ERROR_INSUFFICIENT_SPACE;
+        }
+
+        if (record->size > (self->dataSize - self->dataUsed))
+        {
+            Debug_LOG_ERROR("Cache buffer too small for parameter %.*s",
+                            (int)sizeof(record->name), record->name);
+            return OS_ERROR_INSUFFICIENT_SPACE;
+        }
+
+        ConfigCache_Entry_t* entry = &self->entries[self->numEntries];
+        memcpy(entry->name, record->name, sizeof(entry->name));
+        entry->name[sizeof(entry->name) - 1] = '\0';
+        entry->hash   = hashName(entry->name, sizeof(entry->name));
+        entry->type   = record->type;
+        entry->offset = self->dataUsed;
+        entry->size   = record->size;
+
+        memcpy(&self->data[entry->offset], &record[1], record->size);
+        insertSlot(self, entry->hash, self->numEntries);
+
+        self->dataUsed += record->size;
+        self->numEntries++;
+        pos += recordSize;
+    }
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigCache_init(
+    ConfigCache_t*  self,
+    void*           dataBuffer,
+    size_t          dataBufferSize)
+{
+    if ((NULL == self) || (NULL == dataBuffer))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    memset(self, 0, sizeof(*self));
+    self->data     = dataBuffer;
+    self->dataSize = dataBufferSize;
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigCache_fetchDomain(
+    ConfigCache_t*                  self,
+    const if_ConfigServerBulk_t*    configServer,
+    const char*                     domainName)
+{
+    if ((NULL == self) || (NULL == configServer) || (NULL == domainName))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    memset(self->domain, 0, sizeof(self->domain));
+    strncpy(self->domain, domainName, sizeof(self->domain) - 1);
+    memset(self->slots, 0, sizeof(self->slots));
+    self->numEntries = 0;
+    self->dataUsed = 0;
+
+    const uint8_t* buf = OS_Dataport_getBuf(configServer->dataport);
+    size_t bufSize = OS_Dataport_getSize(configServer->dataport);
+
+    // A domain usually fits into the dataport, big domains take several calls.
+    unsigned int numRemaining;
+    do
+    {
+        unsigned int numParameters;
+        OS_Error_t err = configServer->getDomain(
+                             self->domain,
+                             self->numEntries,
+                             &numParameters,
+                             &numRemaining);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("getDomain() for %s failed with: %d",
+                            self->domain, err);
+            return err;
+        }
+
+        err = addRecords(self, buf, bufSize, numParameters);
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("addRecords() for %s failed with: %d",
+                            self->domain, err);
+            return err;
+        }
+    }
+    while (numRemaining > 0);
+
+    Debug_LOG_DEBUG("Cached %zu parameters (%zu bytes) of %s",
+                    self->numEntries, self->dataUsed, self->domain);
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigCache_getParameter(
+    const ConfigCache_t*    self,
+    const char*             parameterName,
+    void*                   parameterBuffer,
+    size_t                  parameterLength)
+{
+    if ((NULL == self) || (NULL == parameterName) || (NULL == parameterBuffer))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    const ConfigCache_Entry_t* entry = findEntry(self, parameterName);
+    if (NULL == entry)
+    {
+        Debug_LOG_ERROR("Parameter %s not found in %s",
+                        parameterName, self->domain);
+        return OS_ERROR_CONFIG_PARAMETER_NOT_FOUND;
+    }
+
+    return copyEntry(self, entry, parameterBuffer, parameterLength);
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigCache_getParameterById(
+    const ConfigCache_t*    self,
+    size_t                  parameterId,
+    void*                   parameterBuffer,
+    size_t                  parameterLength)
+{
+    if ((NULL == self) || (NULL == parameterBuffer))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (parameterId >= self->numEntries)
+    {
+        Debug_LOG_ERROR("Parameter ID %zu not found in %s",
+                        parameterId, self->domain);
+        return OS_ERROR_CONFIG_PARAMETER_NOT_FOUND;
+    }
+
+    return copyEntry(self,
+                     &self->entries[parameterId],
+                     parameterBuffer,
+                     parameterLength);
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigCache_checkNames(
+    const ConfigCache_t*    self,
+    const char* const*      names,
+    size_t                  numNames)
+{
+    if ((NULL == self) || (NULL == names))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (numNames != self->numEntries)
+    {
+        Debug_LOG_ERROR("%s has %zu parameters, expected %zu",
+                        self->domain, self->numEntries, numNames);
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    for (size_t i = 0; i < numNames; i++)
+    {
+        if (0 != strncmp(self->entries[i].name,
+                         names[i],
+                         OS_CONFIG_LIB_PARAMETER_NAME_SIZE))
+        {
+            Debug_LOG_ERROR("Parameter %zu of %s is %s, expected %s",
+                            i, self->domain, self->entries[i].name, names[i]);
+            return OS_ERROR_INVALID_STATE;
+        }
+    }
+
+    return OS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigCache_getParameterPtr(
+    const ConfigCache_t*    self,
+    const char*             parameterName,
+    const void**            value,
+    size_t*                 valueSize)
+{
+    if ((NULL == self) || (NULL == parameterName) || (NULL == value)
+        || (NULL == valueSize))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    const ConfigCache_Entry_t* entry = findEntry(self, parameterName);
+    if (NULL == entry)
+    {
+        Debug_LOG_ERROR("Parameter %s not found in %s",
+                        parameterName, self->domain);
+        return OS_ERROR_CONFIG_PARAMETER_NOT_FOUND;
+    }
+
+    *value     = &self->data[entry->offset];
+    *valueSize = entry->size;
+
+    return OS_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/*
+ * Client side cache for the parameters of a ConfigServer domain.
+ *
+ * The cache fetches a complete domain with the bulk interface of the
+ * ConfigServer and serves all further lookups from local memory. A lookup by
+ * name takes a single probe of a hash table over the parameter names, one by
+ * ID indexes the entries directly.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "lib_debug/Debug.h"
+
+#include "config_bulk.h"
+
+#if !defined(CONFIG_CACHE_MAX_ENTRIES)
+#define CONFIG_CACHE_MAX_ENTRIES    16
+#endif
+
+// The number of slots must be a power of two. Twice the number of entries
+// keeps the probe sequences short.
+#define CONFIG_CACHE_SLOTS          (2 * CONFIG_CACHE_MAX_ENTRIES)
+
+typedef struct
+{
+    char        name[OS_CONFIG_LIB_PARAMETER_NAME_SIZE];
+    uint32_t    hash;
+    uint32_t    type;
+    size_t      offset;
+    size_t      size;
+} ConfigCache_Entry_t;
+
+typedef struct
+{
+    char                    domain[OS_CONFIG_LIB_DOMAIN_NAME_SIZE];
+    ConfigCache_Entry_t     entries[CONFIG_CACHE_MAX_ENTRIES];
+    size_t                  numEntries;
+
+    // slots hold the entry index + 1, zero marks an empty slot
+    uint16_t                slots[CONFIG_CACHE_SLOTS];
+
+    uint8_t*                data;
+    size_t                  dataSize;
+    size_t                  dataUsed;
+} ConfigCache_t;
+
+
+//------------------------------------------------------------------------------
+// Initialize an empty cache, the values are stored in the given buffer.
+OS_Error_t
+ConfigCache_init(
+    ConfigCache_t*  self,
+    void*           dataBuffer,
+    size_t          dataBufferSize);
+
+//------------------------------------------------------------------------------
+// Fetch all parameters of a domain from the ConfigServer. Any previous content
+// of the cache is dropped.
+OS_Error_t
+ConfigCache_fetchDomain(
+    ConfigCache_t*                  self,
+    const if_ConfigServerBulk_t*    configServer,
+    const char*                     domainName);
+
+//------------------------------------------------------------------------------
+// Copy the value of a cached parameter into the given buffer. Any remaining
+// space in the buffer is cleared, so string values are always terminated if
+// the buffer is bigger than the value.
+OS_Error_t
+ConfigCache_getParameter(
+    const ConfigCache_t*    self,
+    const char*             parameterName,
+    void*                   parameterBuffer,
+    size_t                  parameterLength);
+
+//------------------------------------------------------------------------------
+// Copy the value of a cached parameter into the given buffer like
+// ConfigCache_getParameter(), but find it by its position in the domain. The
+// IDs are generated from config.xml into config_params.h.
+OS_Error_t
+ConfigCache_getParameterById(
+    const ConfigCache_t*    self,
+    size_t                  parameterId,
+    void*                   parameterBuffer,
+    size_t                  parameterLength);
+
+//------------------------------------------------------------------------------
+// Check that the cached parameters have the given names in the given order, so
+// they can be read by their IDs. This is done once after the domain has been
+// fetched.
+OS_Error_t
+ConfigCache_checkNames(
+    const ConfigCache_t*    self,
+    const char* const*      names,
+    size_t                  numNames);
+
+//------------------------------------------------------------------------------
+// Get a pointer to the value of a cached parameter without copying it.
+OS_Error_t
+ConfigCache_getParameterPtr(
+    const ConfigCache_t*    self,
+    const char*             parameterName,
+    const void**            value,
+    size_t*                 valueSize);
@@ -0,0 +1,353 @@
+/*
+ * Read-only snapshot of the ConfigServer parameters in shared memory.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <string.h>
+#include <camkes.h>
+
+#include "lib_debug/Debug.h"
+
+#include "config_snapshot.h"
+
+/* Defines -------------------------------------------------------------------*/
+// The ConfigServer prepares an update aside and only copies it into the
+// snapshot while the version is odd, which takes a few microseconds for the
+// whole dataport. A reader yields before it retries, so the ConfigServer can
+// finish the copy, and should never see more than one or two updates in a row.
+#define MAX_READ_RETRIES    100
+
+// Private functions -----------------------------------------------------------
+
+//------------------------------------------------------------------------------
+static
+uint32_t
+loadVersion(
+    const ConfigSnapshot_Header_t* header)
+{
+    return __atomic_load_n(&header->version, __ATOMIC_ACQUIRE);
+}
+
+//------------------------------------------------------------------------------
+static
+const void*
+getBase(
+    const ConfigSnapshot_t* snapshot)
+{
+    return *snapshot->io;
+}
+
+//------------------------------------------------------------------------------
+// Check that a range lies within the mapping. The values may come from a
+// snapshot that is being updated, so nothing can be taken for granted.
+static
+bool
+isInSnapshot(
+    const ConfigSnapshot_t* snapshot,
+    size_t offset,
+    size_t size)
+{
+    return (offset <= snapshot->size) && (size <= (snapshot->size - offset));
+}
+
+//------------------------------------------------------------------------------
+static
+bool
+isName(
+    const ConfigSnapshot_t* snapshot,
+    uint32_t nameOffset,
+    const char* name,
+    size_t maxLen)
+{
+    if (!isInSnapshot(snapshot, nameOffset, maxLen))
+    {
+        return false;
+    }
+
+    const char* stored = (const char*)getBase(snapshot) + nameOffset;
+    return (0 == strncmp(stored, name, maxLen));
+}
+
+//------------------------------------------------------------------------------
+static
+const ConfigSnapshot_Domain_t*
+findDomain(
+    const ConfigSnapshot_t* snapshot,
+    const char* domainName)
+{
+    const ConfigSnapshot_Header_t* header = getBase(snapshot);
+
+    size_t numDomains = header->numDomains;
+    if (!isInSnapshot(snapshot,
+                      sizeof(*header),
+                      numDomains * sizeof(ConfigSnapshot_Domain_t)))
+    {
+        return NULL;
+    }
+
+    const ConfigSnapshot_Domain_t* domains =
+        (const ConfigSnapshot_Domain_t*)&header[1];
+    uint32_t hash = ConfigSnapshot_hashName(domainName,
+                                            OS_CONFIG_LIB_DOMAIN_NAME_SIZE);
+
+    for (size_t i = 0; i < numDomains; i++)
+    {
+        if ((domains[i].hash == hash)
+            && isName(snapshot,
+                      domains[i].nameOffset,
+                      domainName,
+                      OS_CONFIG_LIB_DOMAIN_NAME_SIZE))
+        {
+            return &domains[i];
+        }
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+static
+OS_Error_t
+readParameter(
+    const ConfigSnapshot_t* snapshot,
+    const char* domainName,
+    const char* parameterName,
+    void* parameterBuffer,
+    size_t parameterLength)
+{
+    const uint8_t* base = getBase(snapshot);
+    const ConfigSnapshot_Header_t* header = getBase(snapshot);
+
+    const ConfigSnapshot_Domain_t* domain = findDomain(snapshot, domainName);
+    if (NULL == domain)
+    {
+        return OS_ERROR_CONFIG_DOMAIN_NOT_FOUND;
+    }
+
+    size_t numDomains = header->numDomains;
+    size_t numEntries = header->numEntries;
+    size_t domainsSize = numDomains * sizeof(ConfigSnapshot_Domain_t);
+    if (!isInSnapshot(snapshot,
+                      sizeof(*header) + domainsSize,
+                      numEntries * sizeof(ConfigSnapshot_Entry_t)))
+    {
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    const ConfigSnapshot_Entry_t* entries =
+        (const ConfigSnapshot_Entry_t*)&base[sizeof(*header) + domainsSize];
+
+    size_t firstEntry = domain->firstEntry;
+    size_t domainEntries = domain->numEntries;
+    if ((firstEntry > numEntries) || (domainEntries > (numEntries - firstEntry)))
+    {
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    uint32_t parameterHash = ConfigSnapshot_hashName(
+                                 parameterName,
+                                 OS_CONFIG_LIB_PARAMETER_NAME_SIZE);
+    for (size_t i = 0; i < domainEntries; i++)
+    {
+        const ConfigSnapshot_Entry_t* entry = &entries[firstEntry + i];
+        if ((entry->hash != parameterHash)
+            || !isName(snapshot,
+                       entry->nameOffset,
+                       parameterName,
+                       OS_CONFIG_LIB_PARAMETER_NAME_SIZE))
+        {
+            continue;
+        }
+
+        size_t valueOffset = entry->valueOffset;
+        size_t valueSize = entry->valueSize;
+        if (!isInSnapshot(snapshot, valueOffset, valueSize))
+        {
+            return OS_ERROR_INVALID_STATE;
+        }
+
+        if (valueSize > parameterLength)
+        {
+            return OS_ERROR_BUFFER_TOO_SMALL;
+        }
+
+        memcpy(parameterBuffer, &base[valueOffset], valueSize);
+        memset((uint8_t*)parameterBuffer + valueSize,
+               0,
+               parameterLength - valueSize);
+
+        return OS_SUCCESS;
+    }
+
+    return OS_ERROR_CONFIG_PARAMETER_NOT_FOUND;
+}
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+uint32_t
+ConfigSnapshot_hashName(
+    const char* name,
+    size_t      maxLen)
+{
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; (i < maxLen) && (name[i] != '\0'); i++)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+ConfigSnapshot_getVersion(
+    const ConfigSnapshot_t* snapshot)
+{
+    const ConfigSnapshot_Header_t* header = getBase(snapshot);
+
+    if (header->magic != ConfigSnapshot_MAGIC)
+    {
+        return 0;
+    }
+
+    return loadVersion(header);
+}
+
+//------------------------------------------------------------------------------
+bool
+ConfigSnapshot_hasChanged(
+    const ConfigSnapshot_t* snapshot,
+    uint32_t*               version)
+{
+    uint32_t current = ConfigSnapshot_getVersion(snapshot);
+
+    // an update in progress is reported once it is complete
+    if ((current == *version) || (current & 1))
+    {
+        return false;
+    }
+
+    *version = current;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+ConfigSnapshot_hasDomainChanged(
+    const ConfigSnapshot_t* snapshot,
+    const char*             domainName,
+    uint32_t*               version)
+{
+    const ConfigSnapshot_Header_t* header = getBase(snapshot);
+
+    if (header->magic != ConfigSnapshot_MAGIC)
+    {
+        return false;
+    }
+
+    for (unsigned int retry = 0; retry < MAX_READ_RETRIES; retry++)
+    {
+        if (retry > 0)
+        {
+            seL4_Yield();
+        }
+
+        uint32_t snapshotVersion = loadVersion(header);
+        if (snapshotVersion & 1)
+        {
+            continue;
+        }
+
+        const ConfigSnapshot_Domain_t* domain =
+            findDomain(snapshot, domainName);
+        uint32_t domainVersion = (NULL == domain) ? 0 : domain->version;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (loadVersion(header) != snapshotVersion)
+        {
+            continue;
+        }
+
+        if ((0 == domainVersion) || (domainVersion == *version))
+        {
+            return false;
+        }
+
+        *version = domainVersion;
+        return true;
+    }
+
+    // the change is reported with one of the next calls
+    return false;
+}
+
+//------------------------------------------------------------------------------
+OS_Error_t
+ConfigSnapshot_getParameter(
+    const ConfigSnapshot_t* snapshot,
+    const char*             domainName,
+    const char*             parameterName,
+    void*                   parameterBuffer,
+    size_t                  parameterLength)
+{
+    if ((NULL == snapshot) || (NULL == domainName) || (NULL == parameterName)
+        || (NULL == parameterBuffer))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    const ConfigSnapshot_Header_t* header = getBase(snapshot);
+
+    if (header->magic != ConfigSnapshot_MAGIC)
+    {
+        Debug_LOG_ERROR("No config snapshot published");
+        return OS_ERROR_NOT_INITIALIZED;
+    }
+
+    for (unsigned int retry = 0; retry < MAX_READ_RETRIES; retry++)
+    {
+        if (retry > 0)
+        {
+            seL4_Yield();
+        }
+
+        uint32_t version = loadVersion(header);
+        if (version & 1)
+        {
+            continue;
+        }
+
+        OS_Error_t err = readParameter(
+                             snapshot,
+                             domainName,
+                             parameterName,
+                             parameterBuffer,
+                             parameterLength);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (loadVersion(header) != version)
+        {
+            continue;
+        }
+
+        if (err != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("Parameter %s of %s failed with: %d",
+                            parameterName, domainName, err);
+        }
+
+        return err;
+    }
+
+    Debug_LOG_ERROR("Config snapshot keeps changing while reading %s",
+                    parameterName);
+    return OS_ERROR_TRY_AGAIN;
+}
@@ -0,0 +1,125 @@
+/*
+ * Read-only snapshot of the ConfigServer parameters in shared memory.
+ *
+ * The ConfigServer publishes all parameters into a dataport that is mapped
+ * read-only into its clients, so a client reads a parameter without any RPC.
+ * The snapshot starts with a header, followed by a table of domains, a table
+ * of parameter entries and a data area with the names and values. All offsets
+ * are relative to the start of the snapshot.
+ *
+ * The version in the header is odd while the ConfigServer updates the
+ * snapshot and is incremented again once the update is complete. A reader
+ * that sees the same even version before and after reading a value got a
+ * consistent value. A client that keeps the version of its last read knows
+ * that nothing has changed as long as the version stays the same.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "OS_ConfigService.h"
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+#define ConfigSnapshot_MAGIC        0x50414e53  // "SNAP"
+
+// Values in the data area are aligned to this number of bytes.
+#define ConfigSnapshot_DATA_ALIGN   4
+
+// Names are stored with their terminating zero and never exceed this size.
+#define ConfigSnapshot_MAX_NAME_SIZE \
+    ((OS_CONFIG_LIB_DOMAIN_NAME_SIZE > OS_CONFIG_LIB_PARAMETER_NAME_SIZE) \
+     ? OS_CONFIG_LIB_DOMAIN_NAME_SIZE : OS_CONFIG_LIB_PARAMETER_NAME_SIZE)
+
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    numDomains;
+    uint32_t    numEntries;
+    uint32_t    dataOffset;
+    uint32_t    dataSize;
+} ConfigSnapshot_Header_t;
+
+typedef struct
+{
+    uint32_t    hash;       // FNV-1a of the domain name
+    uint32_t    nameOffset;
+    uint32_t    firstEntry;
+    uint32_t    numEntries;
+    uint32_t    version;    // changes whenever a parameter of the domain does
+} ConfigSnapshot_Domain_t;
+
+typedef struct
+{
+    uint32_t    hash;       // FNV-1a of the parameter name
+    uint32_t    nameOffset;
+    uint32_t    type;       // OS_ConfigServiceLibTypes_ParameterType_t
+    uint32_t    valueOffset;
+    uint32_t    valueSize;
+} ConfigSnapshot_Entry_t;
+
+// The mapping of the snapshot dataport in a client. Like OS_Dataport_t it
+// refers to the pointer CAmkES sets up for the dataport.
+typedef struct
+{
+    void**  io;
+    size_t  size;
+} ConfigSnapshot_t;
+
+#define ConfigSnapshot_ASSIGN(_port_, _size_)   \
+{                                               \
+    .io     = (void**)&(_port_),                \
+    .size   = (_size_)                          \
+}
+
+//------------------------------------------------------------------------------
+// FNV-1a hash of a name as it is stored in the tables.
+uint32_t
+ConfigSnapshot_hashName(
+    const char* name,
+    size_t      maxLen);
+
+//------------------------------------------------------------------------------
+// Get the current version of the snapshot. Zero means the ConfigServer has not
+// published a snapshot yet.
+uint32_t
+ConfigSnapshot_getVersion(
+    const ConfigSnapshot_t* snapshot);
+
+//------------------------------------------------------------------------------
+// Check if the snapshot has changed since the given version was read. The
+// version is updated to the current one.
+bool
+ConfigSnapshot_hasChanged(
+    const ConfigSnapshot_t* snapshot,
+    uint32_t*               version);
+
+//------------------------------------------------------------------------------
+// Check if any parameter of a domain has changed since the given version of the
+// domain was read. The version is updated to the current one. A client starts
+// with a version of zero, so the first check always reports a change.
+bool
+ConfigSnapshot_hasDomainChanged(
+    const ConfigSnapshot_t* snapshot,
+    const char*             domainName,
+    uint32_t*               version);
+
+//------------------------------------------------------------------------------
+// Copy the value of a parameter into the given buffer. Any remaining space in
+// the buffer is cleared. If the ConfigServer updates the snapshot during the
+// read, the read is repeated. All offsets are checked against the size of the
+// mapping, so a read that races with an update never leaves the snapshot.
+OS_Error_t
+ConfigSnapshot_getParameter(
+    const ConfigSnapshot_t* snapshot,
+    const char*             domainName,
+    const char*             parameterName,
+    void*                   parameterBuffer,
+    size_t                  parameterLength);
@@ -0,0 +1,139 @@
+/*
+ * Ring of log entries in the log dataport of a client.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <camkes.h>
+
+#include "log_ring.h"
+
+_Static_assert(sizeof(LogRing_t) <= LogRing_DATAPORT_SIZE,
+               "log ring does not fit into a dataport page");
+_Static_assert(offsetof(LogRing_t, entries) == LogRing_HEADER_SIZE,
+               "log ring header has the wrong size");
+_Static_assert(LogRing_NUM_ENTRIES >= 2,
+               "log ring has no room for a burst of entries");
+
+// This runs as part of the logging, so nothing here must log.
+
+// A dataport starts zeroed, so a level is only valid with this flag.
+#define LEVEL_VALID     0x100
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+void
+LogRing_push(
+    LogRing_t*  self,
+    const void* entry,
+    void        (*notify)(void))
+{
+    uint32_t head = self->head;
+
+    for (;;)
+    {
+        uint32_t tail = __atomic_load_n(&self->tail, __ATOMIC_SEQ_CST);
+        if ((head - tail) < LogRing_NUM_ENTRIES)
+        {
+            break;
+        }
+
+#if (LOGSERVER_RING_OVERFLOW == LOGSERVER_RING_DROP_NEWEST)
+        __atomic_store_n(&self->dropped, self->dropped + 1, __ATOMIC_RELAXED);
+        return;
+#elif (LOGSERVER_RING_OVERFLOW == LOGSERVER_RING_DROP_OLDEST)
+        // fails if the LogServer has just taken the entry, then there is room
+        if (__atomic_compare_exchange_n(&self->tail, &tail, tail + 1, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        {
+            __atomic_store_n(&self->dropped, self->dropped + 1,
+                             __ATOMIC_RELAXED);
+        }
+#else
+        // the LogServer has been notified when the ring was empty, but it may
+        // not have got to it yet
+        notify();
+        seL4_Yield();
+#endif
+    }
+
+    memcpy(self->entries[head % LogRing_NUM_ENTRIES], entry,
+           LOGSERVER_RING_ENTRY_SIZE);
+    __atomic_store_n(&self->head, head + 1, __ATOMIC_SEQ_CST);
+
+    // The tail is read after the head has been written and the LogServer reads
+    // the head after it has written the tail, so either it still sees the new
+    // entry or it has taken all entries before and is woken up here.
+    if (__atomic_load_n(&self->tail, __ATOMIC_SEQ_CST) == head)
+    {
+        notify();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+LogRing_pop(
+    LogRing_t*  self,
+    void*       entry)
+{
+    for (;;)
+    {
+        uint32_t tail = __atomic_load_n(&self->tail, __ATOMIC_SEQ_CST);
+        uint32_t head = __atomic_load_n(&self->head, __ATOMIC_SEQ_CST);
+        if (tail == head)
+        {
+            return false;
+        }
+
+        memcpy(entry, self->entries[tail % LogRing_NUM_ENTRIES],
+               LOGSERVER_RING_ENTRY_SIZE);
+
+        // the client may have dropped the entry and reused its place while it
+        // was copied, then the copy is discarded
+        if (__atomic_compare_exchange_n(&self->tail, &tail, tail + 1, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        {
+            return true;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+LogRing_setLevel(
+    LogRing_t*  self,
+    uint8_t     level)
+{
+    __atomic_store_n(&self->level, LEVEL_VALID | level, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+bool
+LogRing_getLevel(
+    const LogRing_t*    self,
+    uint8_t*            level)
+{
+    uint32_t value = __atomic_load_n(&self->level, __ATOMIC_RELAXED);
+    if (!(value & LEVEL_VALID))
+    {
+        return false;
+    }
+
+    *level = (uint8_t)value;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+LogRing_getDropped(
+    const LogRing_t* self)
+{
+    return __atomic_load_n(&self->dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,86 @@
+/*
+ * Ring of log entries in the log dataport of a client.
+ *
+ * Instead of calling the LogServer for every entry, a client appends the data
+ * buffer of the entry, as the log emitter has filled it, to a ring in its log
+ * dataport and notifies the LogServer only if the ring was empty before. The
+ * LogServer drains the rings of all clients asynchronously.
+ *
+ * The client is the only one that advances the head, so it must not append
+ * from more than one thread at a time. components/common/common.c holds a lock
+ * from the formatting of an entry until it is in the ring. The tail is advanced by the LogServer and, to drop the oldest
+ * entry on overflow, by the client, both with a compare-and-swap. A client that
+ * finds the ring full does what LOGSERVER_RING_OVERFLOW says.
+ *
+ * The LogServer also publishes the log level of the client in the header, so
+ * the client can filter its entries before they are formatted.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+#define LogRing_DATAPORT_SIZE   4096
+#define LogRing_HEADER_SIZE     128
+
+#define LogRing_NUM_ENTRIES                                                   \
+    ((LogRing_DATAPORT_SIZE - LogRing_HEADER_SIZE) / LOGSERVER_RING_ENTRY_SIZE)
+
+// The layout of the log dataport. The head and the tail are in cache lines of
+// their own, as they are written by different components.
+typedef struct
+{
+    uint32_t    head;       // written by the client only
+    uint32_t    dropped;    // entries the client dropped on overflow
+    uint8_t     reserved1[56];
+    uint32_t    tail;
+    uint32_t    level;      // written by the LogServer only
+    uint8_t     reserved2[56];
+    uint8_t     entries[LogRing_NUM_ENTRIES][LOGSERVER_RING_ENTRY_SIZE];
+} LogRing_t;
+
+//------------------------------------------------------------------------------
+// Append the first LOGSERVER_RING_ENTRY_SIZE bytes of entry, notify is called
+// when the LogServer has to be woken up.
+void
+LogRing_push(
+    LogRing_t*  self,
+    const void* entry,
+    void        (*notify)(void));
+
+//------------------------------------------------------------------------------
+// Copy the oldest entry to entry and remove it. Returns false if the ring is
+// empty.
+bool
+LogRing_pop(
+    LogRing_t*  self,
+    void*       entry);
+
+//------------------------------------------------------------------------------
+// Publish the log level of the client.
+void
+LogRing_setLevel(
+    LogRing_t*  self,
+    uint8_t     level);
+
+//------------------------------------------------------------------------------
+// Get the log level the LogServer has published. Returns false if it has not
+// published one yet.
+bool
+LogRing_getLevel(
+    const LogRing_t*    self,
+    uint8_t*            level);
+
+//------------------------------------------------------------------------------
+// Number of entries the client dropped since it started.
+uint32_t
+LogRing_getDropped(
+    const LogRing_t* self);
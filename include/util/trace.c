@@ -0,0 +1,155 @@
+/*
+ * Tracepoints for the hot paths of a component.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "trace.h"
+
+_Static_assert(sizeof(Trace_Event_t) == 24,
+               "trace event does not match the log format");
+_Static_assert(offsetof(Trace_Ring_t, slots) == Trace_HEADER_SIZE,
+               "trace ring header has the wrong size");
+_Static_assert((Trace_HEADER_SIZE + Trace_NUM_SLOTS * sizeof(Trace_Slot_t))
+               <= Trace_DATAPORT_SIZE,
+               "trace ring does not fit into the dataport");
+_Static_assert((Trace_NUM_SLOTS & (Trace_NUM_SLOTS - 1)) == 0,
+               "the number of trace slots must be a power of two");
+
+// This runs in the hot paths, so nothing here must log.
+
+static struct
+{
+    Trace_Ring_t*           ring;
+    const if_OS_Timer_t*    timer;
+    uint32_t                id;
+} trace;
+
+// Public functions ------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+void
+Trace_init(
+    void*                   port,
+    const if_OS_Timer_t*    timer)
+{
+    trace.timer = timer;
+    __atomic_store_n(&trace.ring, (Trace_Ring_t*)port, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+void
+Trace_setId(
+    uint32_t id)
+{
+    trace.id = id;
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+Trace_getId(void)
+{
+    return trace.id;
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+Trace_getElapsedUs(
+    uint64_t sinceNs)
+{
+    uint64_t ns;
+    if ((NULL == trace.timer)
+        || (TimeServer_getTime(trace.timer, TimeServer_PRECISION_NSEC,
+                               &ns) != OS_SUCCESS)
+        || (0 == sinceNs) || (ns < sinceNs))
+    {
+        return 0;
+    }
+
+    uint64_t us = (ns - sinceNs) / 1000;
+    return (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+}
+
+//------------------------------------------------------------------------------
+void
+Trace_record(
+    Trace_EventId_t event,
+    uint32_t        arg0,
+    uint32_t        arg1,
+    uint32_t        arg2)
+{
+    Trace_Ring_t* ring = __atomic_load_n(&trace.ring, __ATOMIC_ACQUIRE);
+    if (NULL == ring)
+    {
+        return;
+    }
+
+    uint64_t ns;
+    if (TimeServer_getTime(trace.timer, TimeServer_PRECISION_NSEC,
+                           &ns) != OS_SUCCESS)
+    {
+        ns = 0;
+    }
+
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    do
+    {
+        uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if ((head - tail) >= Trace_NUM_SLOTS)
+        {
+            __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+    while (!__atomic_compare_exchange_n(&ring->head, &head, head + 1, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    Trace_Slot_t* slot = &ring->slots[head % Trace_NUM_SLOTS];
+    slot->event.timeNs = ns;
+    slot->event.event = (uint16_t)event;
+    slot->event.reserved = 0;
+    slot->event.args[0] = arg0;
+    slot->event.args[1] = arg1;
+    slot->event.args[2] = arg2;
+
+    // the slot is complete before the LogServer can take it
+    __atomic_store_n(&slot->seq, head + 1, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+bool
+Trace_pop(
+    Trace_Ring_t*   ring,
+    Trace_Event_t*  event)
+{
+    uint32_t tail = ring->tail;
+    Trace_Slot_t* slot = &ring->slots[tail % Trace_NUM_SLOTS];
+
+    // a reserved slot that is still written ends the events for now
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != (tail + 1))
+    {
+        return false;
+    }
+
+    memcpy(event, &slot->event, sizeof(*event));
+
+    // the slot can be reused by the component from here on
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+Trace_getDropped(
+    const Trace_Ring_t* ring)
+{
+    return __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,163 @@
+/*
+ * Tracepoints for the hot paths of a component.
+ *
+ * TRACE_POINT(EVENT, ...) records the time, the event and up to three integer
+ * arguments into a ring in the trace dataport of the component, without any
+ * formatting. The events are declared in trace_events.h. The LogServer takes
+ * the events from the rings periodically and stores them as TRACE records in
+ * the binary log, tools/log_decode.py decodes them with the names from
+ * trace_events.h.
+ *
+ * The ring may be written by several threads of the component. A writer
+ * reserves a slot by advancing the head with a compare-and-swap and marks it
+ * as complete with its sequence number, the LogServer takes complete slots
+ * only. If the ring is full the new event is dropped and counted.
+ *
+ * A component that passes messages on can set the trace id of the message it
+ * works on with TRACE_SET_ID(), the tracepoints on the way of the message pass
+ * Trace_getId() as their first argument. tools/trace_latency.py follows a
+ * message through the components by this id.
+ *
+ * Tracepoints are enabled with TRACEPOINTS, otherwise TRACE_POINT() and
+ * TRACE_INIT() compile to nothing. Their arguments are still type checked but
+ * not evaluated, so they must not have side effects.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+#include "TimeServer.h"
+#include "trace_events.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// The number of slots is a power of two, so the slot of an index does not
+// jump when the index wraps around.
+#define Trace_DATAPORT_SIZE     20480
+#define Trace_HEADER_SIZE       128
+#define Trace_NUM_SLOTS         512
+#define Trace_MAX_ARGS          3
+
+#define TRACE_EVENT_ENUM(_name_, _args_)    TRACE_EVENT_ ## _name_,
+
+typedef enum
+{
+    TRACE_EVENT_NONE = 0,
+    TRACE_EVENTS(TRACE_EVENT_ENUM)
+    TRACE_EVENT_NUM
+} Trace_EventId_t;
+
+// An event as it is stored in the log, little endian.
+typedef struct
+{
+    uint64_t    timeNs;
+    uint16_t    event;
+    uint16_t    reserved;
+    uint32_t    args[Trace_MAX_ARGS];
+} Trace_Event_t;
+
+typedef struct
+{
+    uint32_t        seq;        // index + 1 of the event in the slot
+    uint32_t        reserved;
+    Trace_Event_t   event;
+} Trace_Slot_t;
+
+// The layout of the trace dataport. The head and the tail are in cache lines
+// of their own, as they are written by different components.
+typedef struct
+{
+    uint32_t        head;       // written by the component only
+    uint32_t        dropped;    // events the component dropped
+    uint8_t         reserved1[56];
+    uint32_t        tail;       // written by the LogServer only
+    uint8_t         reserved2[60];
+    Trace_Slot_t    slots[];
+} Trace_Ring_t;
+
+#define TRACE_ARGS_(_0_, _a_, _b_, _c_, ...)                                  \
+    (uint32_t)(_a_), (uint32_t)(_b_), (uint32_t)(_c_)
+
+#if defined(TRACEPOINTS)
+#define TRACE_INIT(_port_, _timer_)     Trace_init(_port_, _timer_)
+#define TRACE_SET_ID(_id_)              Trace_setId(_id_)
+#define TRACE_POINT(_event_, ...)                                             \
+    Trace_record(TRACE_EVENT_ ## _event_,                                     \
+                 TRACE_ARGS_(0, ## __VA_ARGS__, 0, 0, 0))
+#else
+// The arguments are only checked, sizeof() does not evaluate them.
+#define TRACE_INIT(_port_, _timer_)                                           \
+    ((void)sizeof(_port_), (void)sizeof(_timer_))
+#define TRACE_SET_ID(_id_)              ((void)sizeof(_id_))
+#define TRACE_POINT(_event_, ...)                                             \
+    ((void)sizeof(Trace_check(TRACE_EVENT_ ## _event_,                        \
+                              TRACE_ARGS_(0, ## __VA_ARGS__, 0, 0, 0))))
+#endif
+
+static inline int
+Trace_check(
+    Trace_EventId_t event,
+    uint32_t        arg0,
+    uint32_t        arg1,
+    uint32_t        arg2)
+{
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// Set the trace dataport of the component and the timer that stamps the
+// events. Events recorded before are dropped.
+void
+Trace_init(
+    void*                   port,
+    const if_OS_Timer_t*    timer);
+
+//------------------------------------------------------------------------------
+// Set the trace id of the message the component works on, 0 if there is none.
+// Use TRACE_SET_ID(). There is one id per component, so the messages must be
+// handled by one thread at a time.
+void
+Trace_setId(
+    uint32_t id);
+
+//------------------------------------------------------------------------------
+// The trace id set with TRACE_SET_ID().
+uint32_t
+Trace_getId(void);
+
+//------------------------------------------------------------------------------
+// Microseconds from sinceNs, a time of the TimeServer, until now. Saturates at
+// UINT32_MAX and is 0 if the time is not available.
+uint32_t
+Trace_getElapsedUs(
+    uint64_t sinceNs);
+
+//------------------------------------------------------------------------------
+// Record an event, use TRACE_POINT().
+void
+Trace_record(
+    Trace_EventId_t event,
+    uint32_t        arg0,
+    uint32_t        arg1,
+    uint32_t        arg2);
+
+//------------------------------------------------------------------------------
+// Copy the oldest complete event of a ring to event and remove it. Returns
+// false if there is none. Used by the LogServer.
+bool
+Trace_pop(
+    Trace_Ring_t*   ring,
+    Trace_Event_t*  event);
+
+//------------------------------------------------------------------------------
+// Number of events the component dropped since it started.
+uint32_t
+Trace_getDropped(
+    const Trace_Ring_t* ring);
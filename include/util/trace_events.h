@@ -0,0 +1,34 @@
+/*
+ * Events of the tracepoints, see trace.h.
+ *
+ * Every line defines the event TRACE_EVENT_<name> and the names of its
+ * arguments, separated by blanks. The events are numbered from 1 in the order
+ * of the lines. tools/log_decode.py reads this file to decode the events, so a
+ * line must not be split and new events are added at the end.
+ *
+ * An event with the first argument traceId is a stage of a sensor message, see
+ * tools/trace_latency.py.
+ *
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#pragma once
+
+//------------------------------------------------------------------------------
+#define TRACE_EVENTS(_X_)                                                     \
+    _X_(CC_MESSAGE_RX,          "traceId packetType")                         \
+    _X_(CC_PUBLISH_RX,          "traceId count")                              \
+    _X_(CC_PUBLISH_PARSED,      "traceId topicLen payloadLen")                \
+    _X_(CC_PUBLISH_SENT,        "traceId ret e2eUs")                          \
+    _X_(CC_RECONNECT,           "queued")                                     \
+    _X_(SENSOR_WRITE_START,     "traceId len")                                \
+    _X_(SENSOR_WRITE_DONE,      "traceId err")                                \
+    _X_(SENSOR_SAMPLE,          "traceId")                                    \
+    _X_(CC_RPC_RX,              "traceId ipcUs")                              \
+    _X_(CC_PUBLISH_SERIALIZED,  "traceId len")                                \
+    _X_(CC_TLS_WRITTEN,         "traceId len remaining")                      \
+    _X_(CC_PUBACK,              "traceId packetId")
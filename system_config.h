@@ -50,6 +50,52 @@
 
 #endif // !defined(CAMKES_TOOL_PROCESSING)
 
+// The LogServer writes the log file in chunks of this size, which must be a
+// multiple of the 512 byte sectors of the SD card.
+#define LOGSERVER_WRITE_BUFFER_SIZE             4096
+
+// Longest time a log entry is kept in RAM before it is written to the log
+// file. Entries of level ERROR and FATAL are written at once.
+#define LOGSERVER_FLUSH_INTERVAL_MS             2000
+
+// The log is kept in a ring of segment files of a fixed size, the oldest one
+// is overwritten when all are used. The segment size must be a multiple of
+// LOGSERVER_WRITE_BUFFER_SIZE.
+#define LOGSERVER_SEGMENT_SIZE                  (1024 * 1024)
+#define LOGSERVER_NUM_SEGMENTS                  64
+
+// The clients pass their log entries to the LogServer in a ring in the log
+// dataport, see include/util/log_ring.h. An entry takes this much space, which
+// must hold the data buffer the log emitter fills, that is the levels and a
+// message of up to OS_Logger_ENTRY_MESSAGE_LENGTH (350) characters.
+#define LOGSERVER_RING_ENTRY_SIZE               384
+
+// What a client does with a new log entry when its ring is full.
+#define LOGSERVER_RING_DROP_NEWEST              0   // drop the new entry
+#define LOGSERVER_RING_DROP_OLDEST              1   // drop the oldest entry
+#define LOGSERVER_RING_BLOCK                    2   // wait for the LogServer
+
+#if !defined(LOGSERVER_RING_OVERFLOW)
+#define LOGSERVER_RING_OVERFLOW                 LOGSERVER_RING_BLOCK
+#endif
+
+// The LogServer folds a message that a client repeats within its last
+// LOGSERVER_DEDUP_WINDOW different messages into one entry "message repeated
+// N times", which is written after this time or when the message drops out of
+// the window.
+#define LOGSERVER_DEDUP_TIMEOUT_MS              10000
+#define LOGSERVER_DEDUP_WINDOW                  4
+
+// Limits of the entries of a client per level, in entries per second on
+// average and in a burst. Entries over the limit are dropped and counted, a
+// rate of 0 turns the limit off. The boot trace of the CloudConnector is not
+// limited.
+#define LOGSERVER_RATE_LIMIT_BURST              20
+#define LOGSERVER_RATE_LIMIT_ERROR              10  // ASSERT, FATAL and ERROR
+#define LOGSERVER_RATE_LIMIT_WARNING            5
+#define LOGSERVER_RATE_LIMIT_INFO               10
+#define LOGSERVER_RATE_LIMIT_DEBUG              0   // DEBUG and TRACE
+
 //-----------------------------------------------------------------------------
 // Network
 //-----------------------------------------------------------------------------
@@ -70,6 +116,40 @@
 #define CONFIGSERVER_STORAGE_ID     1
 #define LOGGER_STORAGE_ID           2
 
+#define CONFIGSERVER_CLIENT_SENSOR_ID           1
+#define CONFIGSERVER_CLIENT_CLOUDCONNECTOR_ID   2
+#define CONFIGSERVER_CLIENT_NWSTACKCONFIG_ID    3
+#define CONFIGSERVER_CLIENT_ADMIN_ID            4
+
+// An operator component connected to the admin_port of the ConfigServer with
+// CONFIGSERVER_CLIENT_ADMIN_ID may set the log level of every component, see
+// "Log Levels" in the README. The demo has no such component.
+// #define CONFIGSERVER_ADMIN_CLIENT
+
+// The CA certificate decides which server the CloudConnector trusts, so no
+// client may change it at runtime unless this is defined and ServerCaCert is
+// writable in configuration/config.xml.
+// #define CONFIGSERVER_CA_CERT_WRITABLE
+
+// Slots of the components in the boot trace, see include/util/boot_trace.h
+#define BOOT_TRACE_CONFIGSERVER_SLOT            0
+#define BOOT_TRACE_NWSTACKCONFIG_SLOT           1
+#define BOOT_TRACE_CLOUDCONNECTOR_SLOT          2
+#define BOOT_TRACE_SENSOR_SLOT                  3
+
+// Number of sensor messages the CloudConnector keeps while it is not connected
+// to the cloud, the oldest message is dropped when the queue is full.
+#define CLOUDCONNECTOR_PRE_CONNECT_QUEUE_SIZE   16
+
+// Bytes of MQTT packets the CloudConnector collects into one TLS record while
+// it is corked, at most the TLS maximum fragment length of 16 KiB. It fits the
+// metrics together with a sensor message.
+#define CLOUDCONNECTOR_TLS_CORK_SIZE            4096
+
+// Size of the config snapshot dataport, must match the size of the
+// configSnapshot_port in the ConfigServer and its clients.
+#define CONFIG_SNAPSHOT_SIZE    (4 * 4096)
+
 #define NIC_DRIVER_RINGBUFFER_NUMBER_ELEMENTS 16
 #define NIC_DRIVER_RINGBUFFER_SIZE                                             \
     (NIC_DRIVER_RINGBUFFER_NUMBER_ELEMENTS * 4096)
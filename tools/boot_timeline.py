@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+
+#-------------------------------------------------------------------------------
+#
+# Render the boot phase trace of the components as a timeline
+#
+# Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# For commercial licensing, contact: info.cyber@hensoldt.net
+#
+#-------------------------------------------------------------------------------
+#
+# With DEMO_IOT_APP_BOOT_TRACE enabled, the components record the TimeServer
+# time of their boot phases and the CloudConnector writes them to the log once
+# the first message has been published, one line per phase:
+#
+#   ... BOOT_TRACE <component> <phase> <time in ns>
+#
+# The lines may be prefixed by anything the logger adds. This tool collects
+# them from a console or log file capture and prints the phases ordered by
+# time, relative to the first phase.
+#
+# Usage:
+#   boot_timeline.py [-w <bar width>] [console.log]
+#
+#-------------------------------------------------------------------------------
+
+import argparse
+import re
+import sys
+
+TRACE_LINE = re.compile(r"BOOT_TRACE\s+(\S+)\s+(\S+)\s+(\d+)")
+
+# the phase that ends the boot, the time to reach it is reported separately
+FINAL_PHASE = "first_puback"
+
+
+#-------------------------------------------------------------------------------
+def read_phases(f):
+    phases = {}
+    for line in f:
+        match = TRACE_LINE.search(line)
+        if match:
+            component, phase, ns = match.groups()
+            # the trace may have been dumped more than once, keep one entry
+            phases[(component, phase)] = int(ns)
+
+    return sorted(((ns, component, phase)
+                   for (component, phase), ns in phases.items()))
+
+
+#-------------------------------------------------------------------------------
+def render(phases, width):
+    start = phases[0][0]
+    total = phases[-1][0] - start
+    name_width = max(len(c) + len(p) + 1 for _, c, p in phases)
+
+    print("{:>10} {:>10}  {:<{}}  timeline".format(
+          "ms", "delta ms", "phase", name_width))
+
+    previous = start
+    for ns, component, phase in phases:
+        offset = ns - start
+        column = (offset * (width - 1) // total) if total else 0
+        print("{:10.3f} {:10.3f}  {:<{}}  |{}*".format(
+              offset / 1e6, (ns - previous) / 1e6,
+              component + "." + phase, name_width, " " * column))
+        previous = ns
+
+    final = [ns for ns, _, phase in phases if phase == FINAL_PHASE]
+    if final:
+        print("\ntime to {}: {:.3f} ms".format(
+              FINAL_PHASE, (final[0] - start) / 1e6))
+
+
+#-------------------------------------------------------------------------------
+def main():
+    parser = argparse.ArgumentParser(
+        description="Render the boot trace of the components as a timeline")
+    parser.add_argument(
+        "log", nargs="?", type=argparse.FileType("r", errors="replace"),
+        default=sys.stdin, help="console or log capture, default is stdin")
+    parser.add_argument(
+        "-w", "--width", type=int, default=50,
+        help="width of the timeline in characters")
+
+    args = parser.parse_args()
+
+    phases = read_phases(args.log)
+    if not phases:
+        sys.exit("error: no BOOT_TRACE lines found")
+
+    render(phases, max(args.width, 1))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
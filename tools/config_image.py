@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+
+#-------------------------------------------------------------------------------
+#
+# Build and dump the single file config image of the ConfigServer
+#
+# Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# For commercial licensing, contact: info.cyber@hensoldt.net
+#
+#-------------------------------------------------------------------------------
+#
+# The config provisioning tool (cpt) writes the parameters of config.xml into
+# four table files PARAM.BIN, DOMAIN.BIN, STRING.BIN and BLOB.BIN. Each file
+# starts with the number of records and the size of a record, followed by the
+# records. This tool packs the records of all four tables into one image that
+# the ConfigServer loads with a single read, see
+# components/ConfigServer/src/config_image.h.
+#
+# Image layout, all values are 32-bit little endian:
+#
+#   header      magic "CIMG", format version, header size, image size,
+#               CRC-32 of everything after the CRC field, number of sections,
+#               generation
+#   sections    type, number of records, size of a record, offset
+#   records     the records of each table, aligned to 64 bytes
+#
+# Usage:
+#   config_image.py build -d <dir with the table files> -o CONFIG.IMG
+#   config_image.py dump CONFIG.IMG
+#
+#-------------------------------------------------------------------------------
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC           = 0x474d4943
+FORMAT_VERSION  = 2
+SECTION_ALIGN   = 64
+
+HEADER          = struct.Struct("<7I")
+# the CRC covers everything from the number of sections on
+CRC_OFFSET      = 20
+SECTION         = struct.Struct("<4I")
+TABLE_HEADER    = struct.Struct("<2I")
+
+# in the order of ConfigImage_SectionType_t, starting with 1
+TABLES = ["PARAM.BIN", "DOMAIN.BIN", "STRING.BIN", "BLOB.BIN"]
+
+
+#-------------------------------------------------------------------------------
+def align(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+#-------------------------------------------------------------------------------
+def find_table(directory, name):
+    # the cpt and FAT do not agree on the case of the file names
+    for entry in os.listdir(directory):
+        if entry.upper() == name:
+            return os.path.join(directory, entry)
+
+    sys.exit("error: {} not found in {}".format(name, directory))
+
+
+#-------------------------------------------------------------------------------
+def read_table(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if len(data) < TABLE_HEADER.size:
+        sys.exit("error: {} is too short".format(path))
+
+    num_records, size_of_record = TABLE_HEADER.unpack_from(data)
+    records = data[TABLE_HEADER.size:]
+    if len(records) != num_records * size_of_record:
+        sys.exit("error: {} has {} bytes of records, expected {} x {}".format(
+                 path, len(records), num_records, size_of_record))
+
+    return num_records, size_of_record, records
+
+
+#-------------------------------------------------------------------------------
+def build(args):
+    tables = [read_table(find_table(args.directory, name)) for name in TABLES]
+
+    # the section table follows the header, the records follow at their
+    # aligned offsets
+    header_size = HEADER.size
+    offset = align(header_size + len(tables) * SECTION.size, SECTION_ALIGN)
+
+    sections = bytearray()
+    records = bytearray()
+    for section_type, (num_records, size_of_record, data) in \
+            enumerate(tables, start=1):
+        sections += SECTION.pack(section_type, num_records, size_of_record,
+                                 offset)
+        records += data
+        records += bytes(align(len(data), SECTION_ALIGN) - len(data))
+        offset += align(len(data), SECTION_ALIGN)
+
+    first_offset = align(header_size + len(sections), SECTION_ALIGN)
+    body = sections + bytes(first_offset - header_size - len(sections)) \
+        + records
+
+    image_size = header_size + len(body)
+    header = bytearray(HEADER.pack(MAGIC, FORMAT_VERSION, header_size,
+                                   image_size, 0, len(tables), 0))
+    crc = zlib.crc32(bytes(header[CRC_OFFSET:]) + body) & 0xFFFFFFFF
+    struct.pack_into("<I", header, CRC_OFFSET - 4, crc)
+
+    with open(args.output, "wb") as f:
+        f.write(header + body)
+
+    print("{}: {} bytes".format(args.output, image_size))
+
+
+#-------------------------------------------------------------------------------
+def dump(args):
+    with open(args.image, "rb") as f:
+        image = f.read()
+
+    if len(image) < HEADER.size:
+        sys.exit("error: {} is too short".format(args.image))
+
+    magic, version, header_size, image_size, crc, num_sections, \
+        generation = HEADER.unpack_from(image)
+    if magic != MAGIC:
+        sys.exit("error: {} is not a config image".format(args.image))
+
+    actual_crc = zlib.crc32(image[CRC_OFFSET:]) & 0xFFFFFFFF
+
+    print("format version  {}".format(version))
+    print("image size      {} (file has {})".format(image_size, len(image)))
+    print("crc             0x{:08x} ({})".format(
+          crc, "ok" if crc == actual_crc else
+          "MISMATCH, computed 0x{:08x}".format(actual_crc)))
+    print("sections        {}".format(num_sections))
+    print("generation      {}".format(generation))
+
+    for i in range(num_sections):
+        section_type, num_records, size_of_record, offset = \
+            SECTION.unpack_from(image, header_size + i * SECTION.size)
+        name = TABLES[section_type - 1] \
+            if 1 <= section_type <= len(TABLES) else "?"
+        print("  {:<10} {:5} records x {:5} bytes at 0x{:06x}".format(
+              name, num_records, size_of_record, offset))
+
+    ok = (crc == actual_crc) and (image_size == len(image))
+    return 0 if ok else 1
+
+
+#-------------------------------------------------------------------------------
+def main():
+    parser = argparse.ArgumentParser(
+        description="Build and dump the config image of the ConfigServer")
+    commands = parser.add_subparsers(dest="command")
+    commands.required = True
+
+    build_parser = commands.add_parser(
+        "build", help="pack the table files of the cpt into an image")
+    build_parser.add_argument(
+        "-d", "--directory", default=".",
+        help="directory with the table files")
+    build_parser.add_argument(
+        "-o", "--output", default="CONFIG.IMG",
+        help="image file to write")
+
+    dump_parser = commands.add_parser(
+        "dump", help="print the header and sections of an image")
+    dump_parser.add_argument("image", help="image file to read")
+
+    args = parser.parse_args()
+    if args.command == "build":
+        build(args)
+        return 0
+
+    return dump(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
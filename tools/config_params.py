@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+
+#-------------------------------------------------------------------------------
+#
+# Generate the config parameter header from config.xml
+#
+# Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# For commercial licensing, contact: info.cyber@hensoldt.net
+#
+#-------------------------------------------------------------------------------
+#
+# For every domain and parameter of config.xml the header defines
+#
+#   CONFIG_<DOMAIN>_NAME                    name of the domain
+#   CONFIG_<DOMAIN>_NUM_PARAMETERS          number of parameters
+#   CONFIG_<DOMAIN>_PARAMETER_NAMES         initializer with all names by ID
+#   CONFIG_<DOMAIN>_<PARAM>_NAME            name of the parameter
+#   CONFIG_<DOMAIN>_<PARAM>_ID              position of the parameter in its
+#                                           domain, as the ConfigServer
+#                                           returns it
+#   CONFIG_<DOMAIN>_<PARAM>_SIZE            size of the value, the maximum
+#                                           size of a writable one
+#
+# and a typed accessor ConfigParams_<Domain>_<Param>() that reads the value
+# from a ConfigCache_t by its ID. The size of a string includes the
+# terminating zero, a blob has the size of its file. Writable strings and
+# blobs can change their size at runtime. A writable string may have up to
+# MAX_STRING_SIZE bytes, a writable blob up to the size of its file, which
+# therefore reserves the space. The ConfigServer denies longer writes.
+#
+# Usage:
+#   config_params.py -i configuration/config.xml -o config_params.h
+#
+#-------------------------------------------------------------------------------
+
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ElementTree
+
+# see the comment in config.xml
+MAX_STRING_SIZE = 32
+
+C_TYPES = {
+    "int32": ("int32_t", 4),
+    "int64": ("int64_t", 8),
+}
+
+
+#-------------------------------------------------------------------------------
+def identifier(name):
+    name = re.sub(r"^Domain-", "", name)
+    name = re.sub(r"[^A-Za-z0-9]", "_", name)
+    return name
+
+
+#-------------------------------------------------------------------------------
+def macro(name):
+    name = identifier(name)
+    name = re.sub(r"(?<=[a-z0-9])(?=[A-Z][a-z])", "_", name)
+    name = re.sub(r"(?<=[a-z])(?=[A-Z]{2,})", "_", name)
+    return name.upper()
+
+
+#-------------------------------------------------------------------------------
+def value_size(param_type, value, base_dir):
+    if param_type in C_TYPES:
+        return C_TYPES[param_type][1]
+
+    if param_type == "string":
+        return len(value.encode()) + 1
+
+    if param_type == "blob":
+        return os.path.getsize(os.path.join(base_dir, value.lstrip("/")))
+
+    sys.exit("error: unsupported parameter type {}".format(param_type))
+
+
+#-------------------------------------------------------------------------------
+def parse(path):
+    base_dir = os.path.dirname(os.path.abspath(path))
+    domains = []
+
+    for domain in ElementTree.parse(path).getroot().findall("domain"):
+        params = []
+        param = None
+
+        # the elements of a parameter follow its name, they are not nested
+        for element in domain:
+            text = (element.text or "").strip()
+            if element.tag == "param_name":
+                param = {"name": text}
+                params.append(param)
+            elif element.tag == "type":
+                param["type"] = text
+            elif element.tag == "access_policy":
+                param["writable"] = \
+                    element.findtext("write", "false").strip() == "true"
+            elif element.tag == "value":
+                param["size"] = value_size(param["type"], text, base_dir)
+
+        domains.append((domain.get("name"), params))
+
+    return domains
+
+
+#-------------------------------------------------------------------------------
+def accessor(domain_name, domain_macro, param, param_macro):
+    name = "ConfigParams_{}_{}".format(identifier(domain_name),
+                                       identifier(param["name"]))
+    define = "CONFIG_{}_{}".format(domain_macro, param_macro)
+
+    if param["type"] in C_TYPES:
+        arguments = ["{}* value".format(C_TYPES[param["type"]][0])]
+        values = ["value", "sizeof(*value)"]
+    else:
+        arguments = ["void* buffer", "size_t bufferSize"]
+        values = ["buffer", "bufferSize"]
+
+    return [
+        "static inline OS_Error_t",
+        "{}(".format(name),
+        "    const ConfigCache_t* cache,",
+        ",\n".join("    " + argument for argument in arguments) + ")",
+        "{",
+        "    return ConfigCache_getParameterById(",
+        "               cache,",
+        "               {}_ID,".format(define),
+        ",\n".join("               " + value for value in values) + ");",
+        "}",
+    ]
+
+
+#-------------------------------------------------------------------------------
+def generate(domains, source):
+    lines = [
+        "/*",
+        " * Config parameters, generated by tools/config_params.py from",
+        " * {}. Do not edit.".format(source),
+        " */",
+        "",
+        "#pragma once",
+        "",
+        "#include \"config_cache.h\"",
+        "",
+        "#include <stdint.h>",
+    ]
+
+    for domain_name, params in domains:
+        domain_macro = macro(domain_name)
+        prefix = "CONFIG_{}".format(domain_macro)
+
+        lines += [
+            "",
+            "//" + "-" * 78,
+            "// {}".format(domain_name),
+            "//" + "-" * 78,
+            "#define {}_NAME \"{}\"".format(prefix, domain_name),
+            "#define {}_NUM_PARAMETERS {}".format(prefix, len(params)),
+            "",
+        ]
+
+        for param_id, param in enumerate(params):
+            param_macro = macro(param["name"])
+            define = "{}_{}".format(prefix, param_macro)
+
+            lines.append("#define {}_NAME \"{}\"".format(define, param["name"]))
+            lines.append("#define {}_ID {}".format(define, param_id))
+
+            if (param["type"] == "string") and param["writable"]:
+                lines.append("#define {}_SIZE {}".format(define,
+                                                         MAX_STRING_SIZE))
+            else:
+                lines.append("#define {}_SIZE {}".format(define, param["size"]))
+            lines.append("")
+
+        lines.append("#define {}_PARAMETER_NAMES \\".format(prefix))
+        lines.append("{ \\")
+        for param in params:
+            lines.append("    {}_{}_NAME, \\".format(prefix,
+                                                   macro(param["name"])))
+        lines.append("}")
+
+        for param in params:
+            lines.append("")
+            lines += accessor(domain_name, domain_macro, param,
+                              macro(param["name"]))
+
+    return "\n".join(lines) + "\n"
+
+
+#-------------------------------------------------------------------------------
+def main():
+    parser = argparse.ArgumentParser(
+        description="Generate the config parameter header from config.xml")
+    parser.add_argument("-i", "--input", required=True,
+                        help="config.xml to read")
+    parser.add_argument("-o", "--output", required=True,
+                        help="header to write")
+    args = parser.parse_args()
+
+    header = generate(parse(args.input), os.path.basename(args.input))
+
+    # keep the timestamp if nothing has changed, so nothing is rebuilt
+    if os.path.exists(args.output):
+        with open(args.output) as f:
+            if f.read() == header:
+                return 0
+
+    with open(args.output, "w") as f:
+        f.write(header)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
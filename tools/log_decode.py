@@ -0,0 +1,316 @@
+#!/usr/bin/env python3
+
+#-------------------------------------------------------------------------------
+#
+# Decode the binary log files of the LogServer into text
+#
+# Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# For commercial licensing, contact: info.cyber@hensoldt.net
+#
+#-------------------------------------------------------------------------------
+#
+# The LogServer stores every log entry as a binary record on the log partition
+# and leaves the formatting to this tool, see
+# components/LogServer/src/binary_log_format.h.
+#
+# The records are kept in a ring of segment files log00.bin, log01.bin and so
+# on, the index file log.idx names the segment that is written. Segment
+# layout, all values little endian:
+#
+#   header      magic "TLOG", 32-bit format version, 32-bit sequence number,
+#               32-bit segment size
+#   records     sync 0xA5, type, client id, levels (emitter << 4 | consumer),
+#               16-bit payload length, 64-bit time in ms, payload
+#   end         zeros, anything behind them is left from an older use of the
+#               segment
+#
+# The segments are decoded in the order of their sequence numbers. A single
+# log.bin of format version 1, which has no sequence number and no end marker,
+# is still decoded.
+#
+# Record types are MESSAGE (1), NAME (2) of a client id, BOOT (3) and TRACE
+# (4). The output has the columns of the text log with the time in ms
+# resolution:
+#
+#   <id> <name> <hh:mm:ss.mmm> <emitter level> <consumer level> <message>
+#
+# A TRACE record holds tracepoint events of 24 bytes each, a 64-bit time in
+# ns, a 16-bit event id, 16 reserved bits and three 32-bit arguments, see
+# include/util/trace.h. The names of the events and their arguments are read
+# from include/util/trace_events.h. An event is shown with the time in us
+# resolution and the time since the previous event of the client:
+#
+#   <id> <name> <hh:mm:ss.uuuuuu> +<us> <event> <argument>=<value> ...
+#
+# Usage:
+#   log_decode.py <directory with the files of the log partition>
+#   log_decode.py log03.bin log04.bin ...
+#   log_decode.py --events path/to/trace_events.h <directory>
+#
+#-------------------------------------------------------------------------------
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+MAGIC           = b"TLOG"
+FORMAT_VERSION  = 2
+SYNC            = 0xA5
+
+INDEX_MAGIC     = b"TLIX"
+INDEX_VERSION   = 1
+INDEX_FILE      = "log.idx"
+SEGMENT_FILES   = re.compile(r"log\d{2}\.bin$")
+
+FILE_HEADER_V1  = struct.Struct("<4sI")
+FILE_HEADER     = struct.Struct("<4sIII")
+INDEX           = struct.Struct("<4sIIIII")
+RECORD_HEADER   = struct.Struct("<BBBBHQ")
+TRACE_EVENT     = struct.Struct("<QHH3I")
+
+TYPE_MESSAGE    = 1
+TYPE_NAME       = 2
+TYPE_BOOT       = 3
+TYPE_TRACE      = 4
+
+NAME_WIDTH      = 16
+
+TRACE_EVENTS_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                 "..", "include", "util", "trace_events.h")
+TRACE_EVENT_LINE  = re.compile(r'^\s*_X_\(\s*(\w+)\s*,\s*"([^"]*)"\s*\)')
+
+
+#-------------------------------------------------------------------------------
+def format_time(ms):
+    sec, ms = divmod(ms, 1000)
+    minutes, sec = divmod(sec, 60)
+    hours, minutes = divmod(minutes, 60)
+    return "{:02d}:{:02d}:{:02d}.{:03d}".format(hours, minutes, sec, ms)
+
+
+#-------------------------------------------------------------------------------
+def format_time_ns(ns):
+    us = ns // 1000
+    sec, us = divmod(us, 1000000)
+    minutes, sec = divmod(sec, 60)
+    hours, minutes = divmod(minutes, 60)
+    return "{:02d}:{:02d}:{:02d}.{:06d}".format(hours, minutes, sec, us)
+
+
+#-------------------------------------------------------------------------------
+# The events by id, as (name, [argument names]). They are numbered from 1 in
+# the order of the file.
+def read_trace_events(path):
+    events = {}
+    try:
+        with open(path, "r") as f:
+            for line in f:
+                match = TRACE_EVENT_LINE.match(line)
+                if match:
+                    events[len(events) + 1] = (match.group(1),
+                                               match.group(2).split())
+    except OSError as e:
+        sys.stderr.write("warning: no trace events: {}\n".format(e))
+
+    return events
+
+
+#-------------------------------------------------------------------------------
+# Writes the records as text. Other tools derive from it and override the
+# on_*() methods to collect the records instead.
+class Decoder:
+
+    def __init__(self, out, trace_events):
+        self.out = out
+        self.trace_events = trace_events
+        self.names = {}
+        self.last_trace_ns = {}
+        self.boots = 0
+        self.errors = 0
+
+    #---------------------------------------------------------------------------
+    def on_boot(self):
+        self.last_trace_ns = {}
+        self.out.write("---- boot {} ----\n".format(self.boots))
+
+    #---------------------------------------------------------------------------
+    def on_message(self, client_id, time_ms, levels, text):
+        self.out.write("{:02d} {:<{}} {} {:2d} {:2d} {}\n".format(
+                       client_id, self.names.get(client_id, "?"), NAME_WIDTH,
+                       format_time(time_ms), levels >> 4, levels & 0xF, text))
+
+    #---------------------------------------------------------------------------
+    # args has a value for every argument name, there may be more values.
+    def on_trace_event(self, client_id, time_ns, event_name, arg_names, args):
+        values = " ".join("{}={}".format(arg_name, value)
+                          for arg_name, value in zip(arg_names, args))
+
+        last_ns = self.last_trace_ns.get(client_id, time_ns)
+        self.last_trace_ns[client_id] = time_ns
+
+        line = "{:02d} {:<{}} {} +{:d} {} {}".format(
+               client_id, self.names.get(client_id, "?"), NAME_WIDTH,
+               format_time_ns(time_ns), max(time_ns - last_ns, 0) // 1000,
+               event_name, values)
+        self.out.write(line.rstrip() + "\n")
+
+    #---------------------------------------------------------------------------
+    def decode_trace(self, client_id, payload):
+        if len(payload) % TRACE_EVENT.size:
+            self.errors += 1
+
+        for pos in range(0, len(payload) - TRACE_EVENT.size + 1,
+                         TRACE_EVENT.size):
+            time_ns, event, _, *args = TRACE_EVENT.unpack_from(payload, pos)
+
+            event_name, arg_names = self.trace_events.get(
+                event, ("EVENT_{}".format(event), []))
+            self.on_trace_event(client_id, time_ns, event_name, arg_names,
+                                args)
+
+    #---------------------------------------------------------------------------
+    # Decode the records from pos on. With has_end_marker, a zero where a record
+    # should start ends them, otherwise damaged records are skipped.
+    def decode_records(self, data, pos, has_end_marker):
+        while pos + RECORD_HEADER.size <= len(data):
+            sync, rtype, client_id, levels, length, time_ms = \
+                RECORD_HEADER.unpack_from(data, pos)
+            end = pos + RECORD_HEADER.size + length
+
+            if has_end_marker and (sync == 0):
+                return
+
+            if (sync != SYNC) or (end > len(data)):
+                # a torn write, continue with the next sync byte
+                self.errors += 1
+                next_sync = data.find(bytes([SYNC]), pos + 1)
+                if next_sync < 0:
+                    return
+                pos = next_sync
+                continue
+
+            payload = data[pos + RECORD_HEADER.size:end]
+            pos = end
+
+            if rtype == TYPE_BOOT:
+                # the ids and names are announced again after a boot
+                self.boots += 1
+                self.names = {}
+                self.on_boot()
+            elif rtype == TYPE_NAME:
+                self.names[client_id] = payload.decode("utf-8", "replace")
+            elif rtype == TYPE_TRACE:
+                self.decode_trace(client_id, payload)
+            elif rtype == TYPE_MESSAGE:
+                self.on_message(client_id, time_ms, levels,
+                                payload.decode("utf-8", "replace"))
+            else:
+                self.errors += 1
+
+        if (pos < len(data)) and not has_end_marker:
+            self.errors += 1
+
+
+#-------------------------------------------------------------------------------
+# Returns the sequence number of a segment, None for a file of version 1 and
+# exits if it is no log file.
+def read_header(name, data):
+    if len(data) < FILE_HEADER_V1.size:
+        sys.exit("error: {} is too short".format(name))
+
+    magic, version = FILE_HEADER_V1.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit("error: {} is not a binary log file".format(name))
+    if version == 1:
+        return None
+    if (version != FORMAT_VERSION) or (len(data) < FILE_HEADER.size):
+        sys.exit("error: format version {} of {} is not supported".format(
+                 version, name))
+
+    return FILE_HEADER.unpack_from(data)[2]
+
+
+#-------------------------------------------------------------------------------
+# The segments of the ring that belong to the sequence in the index. Segments
+# left from before the index was lost have other sequence numbers.
+def filter_by_index(directory, segments):
+    try:
+        with open(os.path.join(directory, INDEX_FILE), "rb") as f:
+            index = f.read(INDEX.size)
+    except OSError:
+        return segments
+
+    if len(index) < INDEX.size:
+        return segments
+
+    magic, version, num_segments, _, _, sequence = INDEX.unpack(index)
+    if (magic != INDEX_MAGIC) or (version != INDEX_VERSION):
+        return segments
+
+    return [s for s in segments
+            if sequence - num_segments < s[0] <= sequence]
+
+
+#-------------------------------------------------------------------------------
+# Decode the log files with decoder, returns the number of damaged records.
+def decode(paths, decoder):
+    directory = None
+    if (len(paths) == 1) and os.path.isdir(paths[0]):
+        directory = paths[0]
+        paths = [os.path.join(directory, name)
+                 for name in sorted(os.listdir(directory))
+                 if SEGMENT_FILES.match(name)]
+        if not paths:
+            sys.exit("error: no log segments in {}".format(directory))
+
+    segments = []
+    for path in paths:
+        with open(path, "rb") as f:
+            data = f.read()
+
+        sequence = read_header(path, data)
+        if sequence is None:
+            decoder.decode_records(data, FILE_HEADER_V1.size, False)
+        else:
+            segments.append((sequence, path, data))
+
+    if directory:
+        segments = filter_by_index(directory, segments)
+
+    for _, _, data in sorted(segments, key=lambda s: s[0]):
+        decoder.decode_records(data, FILE_HEADER.size, True)
+
+    return decoder.errors
+
+
+#-------------------------------------------------------------------------------
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode the binary log files of the LogServer")
+    parser.add_argument(
+        "log", nargs="+",
+        help="directory with the log files or the segment files, e.g. "
+             "log00.bin")
+    parser.add_argument(
+        "--events", default=TRACE_EVENTS_FILE,
+        help="trace_events.h with the names of the tracepoint events, "
+             "default: %(default)s")
+
+    args = parser.parse_args()
+
+    errors = decode(args.log,
+                    Decoder(sys.stdout, read_trace_events(args.events)))
+    if errors:
+        sys.stderr.write("warning: skipped {} damaged records\n".format(errors))
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
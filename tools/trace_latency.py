@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+
+#-------------------------------------------------------------------------------
+#
+# Attribute the latency of the sensor messages to the stages of their way
+#
+# Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# For commercial licensing, contact: info.cyber@hensoldt.net
+#
+#-------------------------------------------------------------------------------
+#
+# With DEMO_IOT_APP_TRACEPOINTS enabled, the Sensor numbers its messages and
+# passes the number as trace id with the message to the CloudConnector. The
+# tracepoints on the way of a message, from the sampling in the Sensor over the
+# RPC, the MQTT parsing and serialization and the TLS write to the PUBACK of
+# the cloud, record the trace id as their first argument, see
+# include/util/trace_events.h. All events are stamped by the TimeServer, so the
+# events of both components are on one time line.
+#
+# This tool reads the TRACE records from the binary log, see log_decode.py,
+# orders the events of every message by time and reports the time between two
+# consecutive stages as a histogram with buckets of powers of two in us. A
+# stage pair that only some messages pass, e.g. when they were queued while
+# the CloudConnector had no connection, is reported for these messages only.
+#
+# Usage:
+#   trace_latency.py <directory with the files of the log partition>
+#   trace_latency.py --events path/to/trace_events.h log03.bin log04.bin ...
+#
+#-------------------------------------------------------------------------------
+
+import argparse
+import sys
+
+import log_decode
+
+TRACE_ID_ARG    = "traceId"
+BAR_WIDTH       = 40
+
+
+#-------------------------------------------------------------------------------
+# Collects the events with a trace id by message, the messages are numbered
+# anew with every boot.
+class StageCollector(log_decode.Decoder):
+
+    def __init__(self, trace_events):
+        super().__init__(None, trace_events)
+        self.messages = {}
+
+    def on_boot(self):
+        pass
+
+    def on_message(self, client_id, time_ms, levels, text):
+        pass
+
+    def on_trace_event(self, client_id, time_ns, event_name, arg_names, args):
+        if (not arg_names) or (arg_names[0] != TRACE_ID_ARG) or (0 == args[0]):
+            return
+
+        self.messages.setdefault((self.boots, args[0]), []).append(
+            (time_ns, event_name))
+
+
+#-------------------------------------------------------------------------------
+# The latencies in us by stage pair, in the order the pairs are first seen, and
+# the end-to-end latencies.
+def collect_stages(messages):
+    stages = {}
+    total = []
+    for _, events in sorted(messages.items()):
+        # sorted() is stable, so events of the same time keep their order
+        events = sorted(events, key=lambda e: e[0])
+        for (start_ns, start), (end_ns, end) in zip(events, events[1:]):
+            stages.setdefault("{} -> {}".format(start, end), []).append(
+                (end_ns - start_ns) // 1000)
+        if len(events) > 1:
+            total.append((events[-1][0] - events[0][0]) // 1000)
+
+    return stages, total
+
+
+#-------------------------------------------------------------------------------
+def percentile(values, p):
+    return values[min(len(values) - 1, (len(values) * p) // 100)]
+
+
+#-------------------------------------------------------------------------------
+def print_histogram(name, values):
+    values = sorted(values)
+    print("{}\n  n={} min={} p50={} p90={} p99={} max={} us".format(
+          name, len(values), values[0], percentile(values, 50),
+          percentile(values, 90), percentile(values, 99), values[-1]))
+
+    buckets = {}
+    for us in values:
+        buckets[us.bit_length()] = buckets.get(us.bit_length(), 0) + 1
+
+    largest = max(buckets.values())
+    for bucket in range(min(buckets), max(buckets) + 1):
+        count = buckets.get(bucket, 0)
+        low = (1 << (bucket - 1)) if bucket else 0
+        print("  {:>9} .. {:>9} us |{:<{}} {}".format(
+              low, (1 << bucket) - 1, "#" * (count * BAR_WIDTH // largest),
+              BAR_WIDTH, count))
+    print()
+
+
+#-------------------------------------------------------------------------------
+def main():
+    parser = argparse.ArgumentParser(
+        description="Report the latency of the stages of the sensor messages")
+    parser.add_argument(
+        "log", nargs="+",
+        help="directory with the log files or the segment files, e.g. "
+             "log00.bin")
+    parser.add_argument(
+        "--events", default=log_decode.TRACE_EVENTS_FILE,
+        help="trace_events.h with the names of the tracepoint events, "
+             "default: %(default)s")
+
+    args = parser.parse_args()
+
+    collector = StageCollector(log_decode.read_trace_events(args.events))
+    errors = log_decode.decode(args.log, collector)
+    if errors:
+        sys.stderr.write("warning: skipped {} damaged records\n".format(errors))
+
+    stages, total = collect_stages(collector.messages)
+    if not stages:
+        sys.exit("error: no traced messages, are the tracepoints enabled?")
+
+    print("{} messages\n".format(len(collector.messages)))
+    for name, values in stages.items():
+        print_histogram(name, values)
+    print_histogram("end to end", total)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())